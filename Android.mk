@@ -21,6 +21,9 @@ D_CFLAGS += -DNFCC_PN547
 #Gemalto SE support
 D_CFLAGS += -DGEMATO_SE_SUPPORT
 
+#Cache parsed libnfc-brcm.conf settings in a binary file under /data/nfc
+D_CFLAGS += -DNFC_CONFIG_CACHE
+
 ######################################
 # Build shared library system/lib/libnfc-nci.so for stack code.
 
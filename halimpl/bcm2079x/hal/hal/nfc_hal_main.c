@@ -570,7 +570,9 @@ static void nfc_hal_main_send_message (NFC_HDR *p_msg)
 UINT32 nfc_hal_main_task (UINT32 param)
 {
     UINT16   event;
-    UINT8    byte;
+    UINT8    rx_buf[NFC_HAL_RX_BULK_SIZE];
+    UINT16   rx_len, rx_pos;
+    BOOLEAN  msg_received;
     UINT8    num_interfaces;
     UINT8    *p;
     NFC_HDR  *p_msg;
@@ -685,29 +687,33 @@ UINT32 nfc_hal_main_task (UINT32 param)
         {
             while (TRUE)
             {
-                /* Read one byte to see if there is anything waiting to be read */
-                if (USERIAL_Read (USERIAL_NFC_PORT, &byte, 1) == 0)
+                /* Read as much as is waiting, up to one chunk */
+                if ((rx_len = USERIAL_Read (USERIAL_NFC_PORT, rx_buf, NFC_HAL_RX_BULK_SIZE)) == 0)
                 {
                     break;
                 }
 
-                if (nfc_hal_nci_receive_msg (byte))
+                for (rx_pos = 0; rx_pos < rx_len; )
                 {
-                    /* complete of receiving NCI message */
-                    nfc_hal_nci_assemble_nci_msg ();
-                    if (nfc_hal_cb.ncit_cb.p_rcv_msg)
+                    rx_pos += nfc_hal_nci_receive_bulk (rx_buf + rx_pos, (UINT16) (rx_len - rx_pos), &msg_received);
+                    if (msg_received)
                     {
-                        if (nfc_hal_nci_preproc_rx_nci_msg (nfc_hal_cb.ncit_cb.p_rcv_msg))
+                        /* complete of receiving NCI message */
+                        nfc_hal_nci_assemble_nci_msg ();
+                        if (nfc_hal_cb.ncit_cb.p_rcv_msg)
                         {
-                            /* Send NCI message to the stack */
-                            nfc_hal_send_nci_msg_to_nfc_task (nfc_hal_cb.ncit_cb.p_rcv_msg);
+                            if (nfc_hal_nci_preproc_rx_nci_msg (nfc_hal_cb.ncit_cb.p_rcv_msg))
+                            {
+                                /* Send NCI message to the stack */
+                                nfc_hal_send_nci_msg_to_nfc_task (nfc_hal_cb.ncit_cb.p_rcv_msg);
+                            }
+                            else
+                            {
+                                if (nfc_hal_cb.ncit_cb.p_rcv_msg)
+                                    GKI_freebuf(nfc_hal_cb.ncit_cb.p_rcv_msg);
+                            }
+                            nfc_hal_cb.ncit_cb.p_rcv_msg = NULL;
                         }
-                        else
-                        {
-                            if (nfc_hal_cb.ncit_cb.p_rcv_msg)
-                                GKI_freebuf(nfc_hal_cb.ncit_cb.p_rcv_msg);
-                        }
-                        nfc_hal_cb.ncit_cb.p_rcv_msg = NULL;
                     }
                 }
             } /* while (TRUE) */
@@ -511,6 +511,80 @@ BOOLEAN nfc_hal_nci_receive_msg (UINT8 byte)
     return (msg_received);
 }
 
+/*****************************************************************************
+**
+** Function         nfc_hal_nci_receive_bulk
+**
+** Description
+**      Parse a chunk of data already read from the serial port.
+**
+**      Payload bytes are copied into the receive buffer in one go; packet
+**      type and header bytes go through nfc_hal_nci_receive_msg (). Parsing
+**      stops at the end of each NCI message so the caller can dispatch it.
+**
+** Returns          number of bytes consumed from p_data
+**
+*****************************************************************************/
+UINT16 nfc_hal_nci_receive_bulk (UINT8 *p_data, UINT16 len, BOOLEAN *p_msg_received)
+{
+    tNFC_HAL_NCIT_CB *p_cb = &(nfc_hal_cb.ncit_cb);
+    UINT16  consumed = 0;
+    UINT16  copy_len;
+    BOOLEAN is_nci;
+
+    *p_msg_received = FALSE;
+
+    while ((consumed < len) && (*p_msg_received == FALSE))
+    {
+        if (  (p_cb->rcv_state != NFC_HAL_RCV_NCI_PAYLOAD_ST)
+            &&(p_cb->rcv_state != NFC_HAL_RCV_BT_PAYLOAD_ST)  )
+        {
+            /* these states never read from the serial port themselves */
+            *p_msg_received = nfc_hal_nci_receive_msg (p_data[consumed++]);
+            continue;
+        }
+
+        is_nci   = (p_cb->rcv_state == NFC_HAL_RCV_NCI_PAYLOAD_ST);
+        copy_len = len - consumed;
+        if (copy_len > p_cb->rcv_len)
+            copy_len = p_cb->rcv_len;
+
+        if (p_cb->p_rcv_msg)
+        {
+            memcpy ((UINT8 *) (p_cb->p_rcv_msg + 1) + p_cb->p_rcv_msg->offset + p_cb->p_rcv_msg->len,
+                    p_data + consumed, copy_len);
+            p_cb->p_rcv_msg->len += copy_len;
+        }
+        p_cb->rcv_len -= copy_len;
+        consumed      += copy_len;
+
+        if (p_cb->rcv_len == 0)
+        {
+            /* Next, wait for packet type of next message */
+            p_cb->rcv_state = NFC_HAL_RCV_IDLE_ST;
+
+            if (is_nci)
+            {
+                *p_msg_received = TRUE;
+            }
+            else
+            {
+#if (NFC_HAL_TRACE_PROTOCOL == TRUE)
+                if (p_cb->p_rcv_msg)
+                {
+                    /* Display protocol trace message */
+                    DispHciEvt (p_cb->p_rcv_msg);
+                }
+#endif
+                /* received BT message */
+                nfc_hal_nci_proc_rx_bt_msg ();
+            }
+        }
+    }
+
+    return (consumed);
+}
+
 /*******************************************************************************
 **
 ** Function         nfc_hal_nci_preproc_rx_nci_msg
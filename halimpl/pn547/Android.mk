@@ -49,6 +49,10 @@ LOCAL_C_INCLUDES += external/stlport/stlport  bionic/  bionic/libstdc++/include
 
 LOCAL_CFLAGS += -DANDROID \
         -DNXP_UICC_ENABLE -DNXP_HW_SELF_TEST
+# Serve OSAL timers from one CLOCK_MONOTONIC thread instead of POSIX timers
+LOCAL_CFLAGS += -DNXP_TIMER_THREAD
+# Cache parsed libnfc-nxp.conf settings in a binary file under /data/nfc
+LOCAL_CFLAGS += -DNXP_CONFIG_CACHE
 #LOCAL_CFLAGS += -DFELICA_CLT_ENABLE
 #-DNXP_PN547C1_DOWNLOAD
 include $(BUILD_SHARED_LIBRARY)
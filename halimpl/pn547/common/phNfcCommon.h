@@ -41,6 +41,8 @@
 #define PLATFORM_LIB_PATH FW_DLL_ROOT_DIR "libpn547_fw_platform" FW_DLL_EXTENSION
 /* Upgrade the public Key */
 #define PKU_LIB_PATH      FW_DLL_ROOT_DIR "libpn547_fw_pku"      FW_DLL_EXTENSION
+/* Frame CRCs of FW_LIB_PATH, precomputed with nfc_dnld_crc_tool (optional) */
+#define FW_CRC_PATH       FW_DLL_ROOT_DIR "libpn547_fw.crc"
 
 /* HAL Version number (Updated as per release) */
 #define NXP_MW_VERSION_MAJ  (1U)
@@ -562,6 +562,9 @@ NFCSTATUS phDnldNfc_Write(bool_t  bRecoverSeq, pphDnldNfc_Buff_t pData, pphDnldN
 
                 memset(&(gpphDnldContext->tRWInfo),0,sizeof(gpphDnldContext->tRWInfo));
                 (gpphDnldContext->tRWInfo.bFirstWrReq) = TRUE;
+                (gpphDnldContext->tRWChkPt) = (gpphDnldContext->tRWInfo);
+                (gpphDnldContext->bFrameResendCnt) = 0;
+                (gpphDnldContext->dwWrStartTime) = phDnldNfc_GetTimeMs();
 
                 wStatus = phDnldNfc_CmdHandler(gpphDnldContext,phDnldNfc_EventWrite);
 
@@ -821,6 +824,7 @@ void phDnldNfc_SetHwDevHandle(void)
     }
     if (gpphDnldContext != NULL)
     {
+        phDnldNfc_FreeCrcIndex(&(gpphDnldContext->tFwCrcIdx));
         (void ) memset((void *)gpphDnldContext,0,
                                             sizeof(phDnldNfc_DlContext_t));
 
@@ -844,6 +848,7 @@ void phDnldNfc_ReSetHwDevHandle(void)
     if (gpphDnldContext != NULL)
     {
         NXPLOG_FWDNLD_E("Freeing Mem for Dnld Context..")
+        phDnldNfc_FreeCrcIndex(&(gpphDnldContext->tFwCrcIdx));
         free(gpphDnldContext);
         gpphDnldContext = NULL;
     }
@@ -1055,6 +1060,7 @@ NFCSTATUS phDnldNfc_InitImgInfo(void)
     NFCSTATUS wStatus = NFCSTATUS_SUCCESS;
     uint8_t *pImageInfo =  NULL;
     uint16_t ImageInfoLen = 0;
+    uint16_t wIdxFwVer = 0;
 
     /* if memory is not allocated then allocate memory for donwload context structure */
     phDnldNfc_SetHwDevHandle();
@@ -1097,6 +1103,17 @@ NFCSTATUS phDnldNfc_InitImgInfo(void)
 
            /* get the FW version */
            wFwVer = (((uint16_t)(gpphDnldContext->nxp_nfc_fw[5]) << 8U) | (gpphDnldContext->nxp_nfc_fw[4]));
+
+           /* frame CRCs are taken from the index precomputed for this image if
+              present, or computed once per loaded image */
+           if((NFCSTATUS_SUCCESS != phDnldNfc_LoadCrcIndex(&(gpphDnldContext->tFwCrcIdx),
+                   &wIdxFwVer, FW_CRC_PATH)) || (wIdxFwVer != wFwVer) ||
+              (NFCSTATUS_SUCCESS != phDnldNfc_BindCrcIndex(&(gpphDnldContext->tFwCrcIdx),
+                   gpphDnldContext->nxp_nfc_fw, gpphDnldContext->nxp_nfc_fw_len)))
+           {
+               (void)phDnldNfc_BuildCrcIndex(&(gpphDnldContext->tFwCrcIdx),
+                       gpphDnldContext->nxp_nfc_fw, gpphDnldContext->nxp_nfc_fw_len);
+           }
            wStatus = NFCSTATUS_SUCCESS;
        }
        else
@@ -73,6 +73,11 @@ static NFCSTATUS phDnldNfc_SetupResendTimer(pphDnldNfc_DlContext_t pDlContext);
 static NFCSTATUS phDnldNfc_UpdateRsp(pphDnldNfc_DlContext_t   pDlContext, phTmlNfc_TransactInfo_t  *pInfo, uint16_t wPldLen);
 static void phDnldNfc_RspTimeOutCb(uint32_t TimerId, void *pContext);
 static void phDnldNfc_ResendTimeOutCb(uint32_t TimerId, void *pContext);
+static NFCSTATUS phDnldNfc_SendPipeLined(pphDnldNfc_DlContext_t pDlCtxt);
+static bool_t phDnldNfc_PipeLineDone(pphDnldNfc_DlContext_t pDlCtxt, phTmlNfc_TransactInfo_t **ppInfo);
+static NFCSTATUS phDnldNfc_PipeLineWrite(pphDnldNfc_DlContext_t pDlCtxt);
+static bool_t phDnldNfc_PipeLineWrCmpl(pphDnldNfc_DlContext_t pDlCtxt);
+static void phDnldNfc_LogWriteRate(pphDnldNfc_DlContext_t pDlCtxt);
 
 /*
 *************************** Function Definitions ***************************
@@ -367,6 +372,17 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
         NXPLOG_FWDNLD_E("Invalid Input Parameter!!");
         wStatus = PHNFCSTVAL(CID_NFC_DNLD,NFCSTATUS_INVALID_PARAMETER);
     }
+    else if((NULL != pInfo) &&
+            ((pInfo->pBuff) == (pDlCtxt->tPipeLineWrFrameInfo.aFrameBuff)) &&
+            (FALSE == phDnldNfc_PipeLineWrCmpl(pDlCtxt)))
+    {
+        /* Late write completion of an abandoned attempt */
+    }
+    else if((phDnldNfc_StatePipelined == pDlCtxt->tCurrState) &&
+            (FALSE == phDnldNfc_PipeLineDone(pDlCtxt,&pInfo)))
+    {
+        /* Wait for the other half of the write/response pair */
+    }
     else
     {
         switch(pDlCtxt->tCurrState)
@@ -403,7 +419,12 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
                     pDlCtxt->bResendLastFrame = FALSE;
                 }
 
-                if(NFCSTATUS_SUCCESS == wStatus)
+                if((NFCSTATUS_SUCCESS == wStatus) &&
+                   (phDnldNfc_EventWrite == pDlCtxt->tCurrEvent))
+                {
+                    wStatus = phDnldNfc_SendPipeLined(pDlCtxt);
+                }
+                else if(NFCSTATUS_SUCCESS == wStatus)
                 {
                     pDlCtxt->tCurrState = phDnldNfc_StateRecv;
 
@@ -493,6 +514,30 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
                     (pDlCtxt->TimerInfo.wTimerExpStatus) = 0;
                 }
 
+                if(phDnldNfc_EventWrite == pDlCtxt->tCurrEvent)
+                {
+                    if((NFCSTATUS_SUCCESS == wStatus) &&
+                       (FALSE == (pDlCtxt->tRWInfo.bFramesSegmented)) &&
+                       (FALSE == (pDlCtxt->tRWInfo.bFirstChunkResp)))
+                    {
+                        /* Frame fully acknowledged, resume from here on a transient failure */
+                        pDlCtxt->tRWChkPt = pDlCtxt->tRWInfo;
+                        pDlCtxt->bFrameResendCnt = 0;
+                    }
+                    else if((NFCSTATUS_RF_TIMEOUT == wStatus) &&
+                            (PH_DL_STATUS_SIGNATURE_ERROR != (pDlCtxt->tLastStatus)) &&
+                            (PHDNLDNFC_MAX_FRAME_RESEND > (pDlCtxt->bFrameResendCnt)))
+                    {
+                        /* Lost frame or response: resend from the last acknowledged frame
+                           instead of failing the whole download */
+                        NXPLOG_FWDNLD_W("Resending write frame at offset %d",
+                                (pDlCtxt->tRWChkPt.wOffset));
+                        (pDlCtxt->bFrameResendCnt)++;
+                        pDlCtxt->tRWInfo = pDlCtxt->tRWChkPt;
+                        wStatus = NFCSTATUS_SUCCESS;
+                    }
+                }
+
                 if((0 != (pDlCtxt->tRWInfo.wRemBytes)) && (NFCSTATUS_SUCCESS == wStatus))
                 {
                     /* Abort TML read operation which is always kept open */
@@ -505,7 +550,12 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
 
                     wStatus = phDnldNfc_BuildFramePkt(pDlCtxt);
 
-                    if(NFCSTATUS_SUCCESS == wStatus)
+                    if((NFCSTATUS_SUCCESS == wStatus) &&
+                       (phDnldNfc_EventWrite == pDlCtxt->tCurrEvent))
+                    {
+                        wStatus = phDnldNfc_SendPipeLined(pDlCtxt);
+                    }
+                    else if(NFCSTATUS_SUCCESS == wStatus)
                     {
                         pDlCtxt->tCurrState = phDnldNfc_StateRecv;
                         wStatus = phTmlNfc_Write((pDlCtxt->tCmdRspFrameInfo.aFrameBuff),
@@ -532,6 +582,12 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
                          NXPLOG_FWDNLD_W("Tml read abort failed!");
                     }
 
+                    if((phDnldNfc_EventWrite == pDlCtxt->tCurrEvent) &&
+                       (NFCSTATUS_SUCCESS == wStatus))
+                    {
+                        phDnldNfc_LogWriteRate(pDlCtxt);
+                    }
+
                     pDlCtxt->tCurrEvent = phDnldNfc_EventInvalid;
                     pDlCtxt->tDnldInProgress = phDnldNfc_TransitionIdle;
                     pDlCtxt->tCurrState = phDnldNfc_StateInit;
@@ -562,6 +618,238 @@ static void phDnldNfc_ProcessRWSeqState(void *pContext, phTmlNfc_TransactInfo_t
     return;
 }
 
+/*******************************************************************************
+**
+** Function         phDnldNfc_SendPipeLined
+**
+** Description      Sends the write frame built in tCmdRspFrameInfo with the
+**                  response read and timer already armed, so the response is
+**                  picked up as soon as PN547 sends it and the next frame can
+**                  follow back to back. The frame is kept in
+**                  tPipeLineWrFrameInfo so the response does not overwrite it
+**                  and it can be resent after a MEM_BSY status.
+**
+** Parameters       pDlCtxt - pointer to the download context structure
+**
+** Returns          NFC status of the TML write request
+**
+*******************************************************************************/
+static NFCSTATUS phDnldNfc_SendPipeLined(pphDnldNfc_DlContext_t pDlCtxt)
+{
+    NFCSTATUS wStatus;
+
+    if((pDlCtxt->tCmdRspFrameInfo.dwSendlength) != 0)
+    {
+        memcpy((pDlCtxt->tPipeLineWrFrameInfo.aFrameBuff),
+               (pDlCtxt->tCmdRspFrameInfo.aFrameBuff),
+               (pDlCtxt->tCmdRspFrameInfo.dwSendlength));
+        (pDlCtxt->tPipeLineWrFrameInfo.dwSendlength) = (pDlCtxt->tCmdRspFrameInfo.dwSendlength);
+        (pDlCtxt->tCmdRspFrameInfo.dwSendlength) = 0;
+    }
+
+    pDlCtxt->bPipeLineWrDone = FALSE;
+    pDlCtxt->bPipeLineRspRecvd = FALSE;
+    pDlCtxt->tCurrState = phDnldNfc_StatePipelined;
+
+    /* Tag this attempt, so completions of earlier attempts can be told apart */
+    (pDlCtxt->bPipeLineAttempt)++;
+    if(0 == (pDlCtxt->bPipeLineAttempt))
+    {
+        (pDlCtxt->bPipeLineAttempt)++;
+    }
+
+    wStatus = phOsalNfc_Timer_Start((pDlCtxt->TimerInfo.dwRspTimerId),
+                                PHDNLDNFC_RSP_TIMEOUT,
+                                &phDnldNfc_RspTimeOutCb,
+                                pDlCtxt);
+    if (NFCSTATUS_SUCCESS == wStatus)
+    {
+        pDlCtxt->TimerInfo.TimerStatus = 1;
+    }
+    else
+    {
+        NXPLOG_FWDNLD_W("Response timer not started");
+    }
+
+    wStatus = phTmlNfc_Read(
+        pDlCtxt->tCmdRspFrameInfo.aFrameBuff,
+        (uint16_t )PHDNLDNFC_CMDRESP_MAX_BUFF_SIZE,
+        (pphTmlNfc_TransactCompletionCb_t)&phDnldNfc_ProcessRWSeqState,
+        (void *)pDlCtxt);
+    if(NFCSTATUS_PENDING != wStatus)
+    {
+        NXPLOG_FWDNLD_W("Response read not posted");
+    }
+
+    if(0 != (pDlCtxt->bPipeLineWrAttempt))
+    {
+        /* The write of an attempt abandoned after a response timeout is still
+           in TML; send this frame once its completion has been consumed */
+        NXPLOG_FWDNLD_W("Deferring write frame until attempt %d completes",
+                (pDlCtxt->bPipeLineWrAttempt));
+        pDlCtxt->bPipeLineWrDeferred = TRUE;
+        wStatus = NFCSTATUS_PENDING;
+    }
+    else
+    {
+        pDlCtxt->bPipeLineWrDeferred = FALSE;
+        wStatus = phDnldNfc_PipeLineWrite(pDlCtxt);
+    }
+
+    return wStatus;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_PipeLineWrite
+**
+** Description      Hands the frame in tPipeLineWrFrameInfo to TML and records
+**                  the attempt it belongs to
+**
+** Parameters       pDlCtxt - pointer to the download context structure
+**
+** Returns          NFC status of the TML write request
+**
+*******************************************************************************/
+static NFCSTATUS phDnldNfc_PipeLineWrite(pphDnldNfc_DlContext_t pDlCtxt)
+{
+    NFCSTATUS wStatus;
+
+    wStatus = phTmlNfc_Write((pDlCtxt->tPipeLineWrFrameInfo.aFrameBuff),
+        (uint16_t)(pDlCtxt->tPipeLineWrFrameInfo.dwSendlength),
+                    (pphTmlNfc_TransactCompletionCb_t)&phDnldNfc_ProcessRWSeqState,
+                    pDlCtxt);
+    if(NFCSTATUS_PENDING == wStatus)
+    {
+        pDlCtxt->bPipeLineWrAttempt = pDlCtxt->bPipeLineAttempt;
+    }
+
+    return wStatus;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_PipeLineWrCmpl
+**
+** Description      Matches a TML write completion of tPipeLineWrFrameInfo with
+**                  the attempt that sent it. TML runs one write at a time, so
+**                  the completion belongs to the attempt recorded at send time.
+**                  A completion of an earlier attempt is dropped and, if the
+**                  current frame was deferred behind it, that frame is sent.
+**
+** Parameters       pDlCtxt - pointer to the download context structure
+**
+** Returns          TRUE if the completion belongs to the frame in flight,
+**                  FALSE if it has to be ignored
+**
+*******************************************************************************/
+static bool_t phDnldNfc_PipeLineWrCmpl(pphDnldNfc_DlContext_t pDlCtxt)
+{
+    uint8_t bAttempt = (pDlCtxt->bPipeLineWrAttempt);
+    NFCSTATUS wStatus;
+
+    pDlCtxt->bPipeLineWrAttempt = 0;
+
+    if((bAttempt == (pDlCtxt->bPipeLineAttempt)) &&
+       (phDnldNfc_StatePipelined == (pDlCtxt->tCurrState)))
+    {
+        return TRUE;
+    }
+
+    NXPLOG_FWDNLD_W("Ignoring write completion of attempt %d (current %d)",
+            bAttempt, (pDlCtxt->bPipeLineAttempt));
+
+    if((TRUE == (pDlCtxt->bPipeLineWrDeferred)) &&
+       (phDnldNfc_StatePipelined == (pDlCtxt->tCurrState)))
+    {
+        pDlCtxt->bPipeLineWrDeferred = FALSE;
+        wStatus = phDnldNfc_PipeLineWrite(pDlCtxt);
+        if(NFCSTATUS_PENDING != wStatus)
+        {
+            /* The response timer will expire and resend the frame */
+            NXPLOG_FWDNLD_E("Deferred write frame not sent (0x%x)", wStatus);
+        }
+    }
+
+    return FALSE;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_PipeLineDone
+**
+** Description      Tracks the write completion and the response of a frame
+**                  sent by phDnldNfc_SendPipeLined, which may reach the
+**                  callback thread in either order
+**
+** Parameters       pDlCtxt - pointer to the download context structure
+**                  ppInfo  - TML transaction info; updated to the response
+**                            when it arrived before the write completion
+**
+** Returns          TRUE if the response can now be processed (or the frame
+**                  failed), FALSE if the other half is still outstanding
+**
+*******************************************************************************/
+static bool_t phDnldNfc_PipeLineDone(pphDnldNfc_DlContext_t pDlCtxt, phTmlNfc_TransactInfo_t **ppInfo)
+{
+    phTmlNfc_TransactInfo_t *pInfo = *ppInfo;
+
+    if(NULL == pInfo)
+    {
+        /* Response timer expired */
+    }
+    else if((pInfo->pBuff) == (pDlCtxt->tPipeLineWrFrameInfo.aFrameBuff))
+    {
+        if(NFCSTATUS_SUCCESS != phDnldNfc_ProcessRecvInfo(pDlCtxt,pInfo))
+        {
+            /* Setting TimerExpStatus below to avoid frame processing in reponse state */
+            (pDlCtxt->TimerInfo.wTimerExpStatus) = NFCSTATUS_RF_TIMEOUT;
+        }
+        else if(FALSE == pDlCtxt->bPipeLineRspRecvd)
+        {
+            pDlCtxt->bPipeLineWrDone = TRUE;
+            return FALSE;
+        }
+        else
+        {
+            *ppInfo = &(pDlCtxt->tPipeLineRspInfo);
+        }
+    }
+    else if(FALSE == pDlCtxt->bPipeLineWrDone)
+    {
+        pDlCtxt->tPipeLineRspInfo = *pInfo;
+        pDlCtxt->bPipeLineRspRecvd = TRUE;
+        return FALSE;
+    }
+
+    pDlCtxt->tCurrState = phDnldNfc_StateTimer;
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_LogWriteRate
+**
+** Description      Logs the duration and throughput of a completed write request
+**
+** Parameters       pDlCtxt - pointer to the download context structure
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phDnldNfc_LogWriteRate(pphDnldNfc_DlContext_t pDlCtxt)
+{
+    uint32_t dwElapsed = phDnldNfc_GetTimeMs() - (pDlCtxt->dwWrStartTime);
+
+    if(0 == dwElapsed)
+    {
+        dwElapsed = 1;
+    }
+    NXPLOG_FWDNLD_D("Wrote %d bytes in %d ms (%d KB/s)",
+            (pDlCtxt->tUserData.wLen), dwElapsed,
+            ((pDlCtxt->tUserData.wLen) * 1000 / 1024) / dwElapsed);
+}
+
 /*******************************************************************************
 **
 ** Function         phDnldNfc_BuildFramePkt
@@ -689,8 +977,14 @@ static NFCSTATUS phDnldNfc_BuildFramePkt(pphDnldNfc_DlContext_t pDlContext)
                     }
                 }
 
-                /* calculate CRC16 */
-                wCrcVal = phDnldNfc_CalcCrc16((pDlContext->tCmdRspFrameInfo.aFrameBuff),wFrameLen);
+                /* calculate CRC16, unless the frame is sent as is from the loaded image */
+                if((phDnldNfc_FTWrite != (pDlContext->FrameInp.Type)) ||
+                   (0 != (pDlContext->tRWInfo.wRWPldSize)) ||
+                   (NFCSTATUS_SUCCESS != phDnldNfc_GetFrameCrc(&(pDlContext->tFwCrcIdx),
+                        (pDlContext->tUserData.pBuff),(pDlContext->tRWInfo.wOffset),&wCrcVal)))
+                {
+                    wCrcVal = phDnldNfc_CalcCrc16((pDlContext->tCmdRspFrameInfo.aFrameBuff),wFrameLen);
+                }
 
                 pFrameByte = (uint8_t *)&wCrcVal;
 
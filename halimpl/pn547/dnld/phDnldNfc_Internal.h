@@ -23,11 +23,15 @@
 #include <phDnldNfc.h>
 #include <phDnldNfc_Cmd.h>
 #include <phDnldNfc_Status.h>
+#include <phTmlNfc.h>
+#include <phDnldNfc_Utils.h>
 
 #define PHDNLDNFC_CMDRESP_MAX_BUFF_SIZE   (0x100U)  /* DL Host Frame Buffer Size for all CMD/RSP
                                                          except pipelined WRITE */
 #define PHDNLDNFC_WRITERSP_BUFF_SIZE  (0x08U)   /* DL Host Short Frame Buffer Size for pipelined WRITE RSP */
 
+#define PHDNLDNFC_MAX_FRAME_RESEND  (0x03U)   /* Resends of a write frame after a transient failure */
+
 #define PHDNLDNFC_FRAME_HDR_LEN  (0x02U)   /* DL Host Frame Buffer Header Length */
 #define PHDNLDNFC_FRAME_CRC_LEN  (PHDNLDNFC_FRAME_HDR_LEN)   /* DL Host Frame Buffer CRC Length */
 #define PHDNLDNFC_FRAME_ID_LEN   (0x01U)    /* Length of Cmd Id */
@@ -168,6 +172,16 @@ typedef struct phDnldNfc_DlContext
     phDnldNfc_Buff_t        tTKey;                 /* Defualt Transport Key provided by caller */
     phDnldNfc_RWInfo_t      tRWInfo;               /* Read/Write segmented frame info */
     phDnldNfc_Status_t      tLastStatus;           /* saved status to distinguish signature or pltform recovery */
+    phDnldNfc_RWInfo_t      tRWChkPt;              /* Write progress at the last fully acknowledged frame */
+    uint8_t                 bFrameResendCnt;       /* Resends of the current frame after a transient failure */
+    bool_t                  bPipeLineWrDone;       /* Write of the pipelined frame completed */
+    bool_t                  bPipeLineRspRecvd;     /* Response received ahead of the write completion */
+    phTmlNfc_TransactInfo_t tPipeLineRspInfo;      /* Saved response in that case */
+    uint8_t                 bPipeLineAttempt;      /* Attempt number of the frame being sent, never 0 */
+    uint8_t                 bPipeLineWrAttempt;    /* Attempt whose write is pending in TML, 0 if none */
+    bool_t                  bPipeLineWrDeferred;   /* Frame waits for the write of an abandoned attempt */
+    uint32_t                dwWrStartTime;         /* Start of the write request, in ms */
+    phDnldNfc_CrcIndex_t    tFwCrcIdx;             /* Precomputed frame CRCs of nxp_nfc_fw */
 }phDnldNfc_DlContext_t,*pphDnldNfc_DlContext_t; /* pointer to #phDnldNfc_DlContext_t structure */
 
 /* The phDnldNfc_CmdHandler function declaration */
@@ -21,6 +21,12 @@
 
 #include <phDnldNfc_Utils.h>
 #include <phNxpLog.h>
+#include <phDnldNfc_Internal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
 
 static uint16_t const aCrcTab[256] =
 { 0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7, 0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad,
@@ -44,6 +50,45 @@ static uint16_t const aCrcTab[256] =
   0x4c45, 0x3ca2, 0x2c83, 0x1ce0, 0x0cc1, 0xef1f, 0xff3e, 0xcf5d, 0xdf7c, 0xaf9b, 0xbfba, 0x8fd9, 0x9ff8,
   0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0 };
 
+/* aCrcSliceTab[k][x] is the CRC16 of byte x followed by k zero bytes, so that
+   8 input bytes can be folded into the CRC with one lookup each */
+static uint16_t aCrcSliceTab[8][256];
+static pthread_once_t tCrcSliceTabOnce = PTHREAD_ONCE_INIT;
+
+/* CRC index file: magic, FW version, number of frames, then offset and CRC16
+   of each frame, all little endian */
+static uint8_t const aCrcIdxMagic[4] = { 'N', 'X', 'C', 'I' };
+#define PHDNLDNFC_CRCIDX_HDR_LEN     (8U)
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_InitCrcSliceTab
+**
+** Description      Derives the slice-by-8 CRC16 tables from aCrcTab
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phDnldNfc_InitCrcSliceTab(void)
+{
+    uint32_t i, k;
+
+    for (i = 0; i < 256; i++)
+    {
+        aCrcSliceTab[0][i] = aCrcTab[i];
+    }
+    for (k = 1; k < 8; k++)
+    {
+        for (i = 0; i < 256; i++)
+        {
+            aCrcSliceTab[k][i] = (uint16_t)(aCrcSliceTab[k - 1][i] << 8U) ^
+                                 aCrcTab[aCrcSliceTab[k - 1][i] >> 8U];
+        }
+    }
+}
+
 /*******************************************************************************
 **
 ** Function         phDnldNfc_CalcCrc16
@@ -61,7 +106,7 @@ uint16_t phDnldNfc_CalcCrc16(uint8_t* pBuff, uint16_t wLen)
     uint16_t wTmp;
     uint16_t wValue;
     uint16_t wCrc = 0xffff;
-    uint32_t i;
+    uint32_t i = 0;
 
 
     if((NULL == pBuff) || (0 == wLen))
@@ -70,8 +115,22 @@ uint16_t phDnldNfc_CalcCrc16(uint8_t* pBuff, uint16_t wLen)
     }
     else
     {
-        /* Perform CRC calculation according to ccitt with a initial value of 0x1d0f */
-        for (i = 0; i < wLen; i++)
+        (void)pthread_once(&tCrcSliceTabOnce, &phDnldNfc_InitCrcSliceTab);
+
+        /* Perform CRC calculation according to ccitt with a initial value of 0x1d0f,
+           8 bytes at a time */
+        for (; (i + 8) <= wLen; i += 8)
+        {
+            wCrc = aCrcSliceTab[7][(wCrc >> 8U) ^ pBuff[i]] ^
+                   aCrcSliceTab[6][(wCrc & 0xffU) ^ pBuff[i + 1]] ^
+                   aCrcSliceTab[5][pBuff[i + 2]] ^
+                   aCrcSliceTab[4][pBuff[i + 3]] ^
+                   aCrcSliceTab[3][pBuff[i + 4]] ^
+                   aCrcSliceTab[2][pBuff[i + 5]] ^
+                   aCrcSliceTab[1][pBuff[i + 6]] ^
+                   aCrcSliceTab[0][pBuff[i + 7]];
+        }
+        for (; i < wLen; i++)
         {
            wValue = 0x00ffU & (uint16_t) pBuff[i];
            wTmp = (wCrc >> 8U) ^ wValue;
@@ -81,3 +140,358 @@ uint16_t phDnldNfc_CalcCrc16(uint8_t* pBuff, uint16_t wLen)
 
     return wCrc;
 }
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_GetTimeMs
+**
+** Description      Reads the monotonic clock, used to measure download time
+**
+** Parameters       None
+**
+** Returns          current time in ms
+**
+*******************************************************************************/
+uint32_t phDnldNfc_GetTimeMs(void)
+{
+    struct timespec tNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &tNow);
+
+    return (uint32_t)((tNow.tv_sec * 1000) + (tNow.tv_nsec / 1000000));
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_BuildCrcIndex
+**
+** Description      Computes the CRC16 of every frame of a firmware image, so
+**                  frames sent unsegmented do not need their CRC computed
+**                  again on each download attempt
+**
+** Parameters       pIndex - index to fill, previous content is released
+**                  pImg   - firmware image, a sequence of length-prefixed frames
+**                  wLen   - image length
+**
+** Returns          NFC status
+**
+*******************************************************************************/
+NFCSTATUS phDnldNfc_BuildCrcIndex(pphDnldNfc_CrcIndex_t pIndex, const uint8_t *pImg, uint16_t wLen)
+{
+    uint32_t dwOffset;
+    uint16_t wFrameLen;
+    uint16_t wNumFrames = 0;
+
+    if((NULL == pIndex) || (NULL == pImg) || (0 == wLen))
+    {
+        NXPLOG_FWDNLD_E("Invalid Input Parameters!!");
+        return PHNFCSTVAL(CID_NFC_DNLD, NFCSTATUS_INVALID_PARAMETER);
+    }
+
+    phDnldNfc_FreeCrcIndex(pIndex);
+
+    for (dwOffset = 0; (dwOffset + PHDNLDNFC_FRAME_HDR_LEN) <= wLen;
+            dwOffset += PHDNLDNFC_FRAME_HDR_LEN + wFrameLen)
+    {
+        wFrameLen = (((uint16_t)pImg[dwOffset] << 8U) | pImg[dwOffset + 1]);
+        if ((dwOffset + PHDNLDNFC_FRAME_HDR_LEN + wFrameLen) > wLen)
+        {
+            break;
+        }
+        wNumFrames++;
+    }
+
+    pIndex->pOffset = (uint16_t *)malloc(wNumFrames * sizeof(uint16_t));
+    pIndex->pCrc = (uint16_t *)malloc(wNumFrames * sizeof(uint16_t));
+    if((0 == wNumFrames) || (NULL == pIndex->pOffset) || (NULL == pIndex->pCrc))
+    {
+        NXPLOG_FWDNLD_W("Image CRC index not built");
+        phDnldNfc_FreeCrcIndex(pIndex);
+        return NFCSTATUS_FAILED;
+    }
+
+    dwOffset = 0;
+    for (pIndex->wNumFrames = 0; pIndex->wNumFrames < wNumFrames; (pIndex->wNumFrames)++)
+    {
+        wFrameLen = (((uint16_t)pImg[dwOffset] << 8U) | pImg[dwOffset + 1]);
+        pIndex->pOffset[pIndex->wNumFrames] = (uint16_t)dwOffset;
+        pIndex->pCrc[pIndex->wNumFrames] = phDnldNfc_CalcCrc16((uint8_t *)&pImg[dwOffset],
+                (PHDNLDNFC_FRAME_HDR_LEN + wFrameLen));
+        dwOffset += PHDNLDNFC_FRAME_HDR_LEN + wFrameLen;
+    }
+    pIndex->pImg = pImg;
+
+    NXPLOG_FWDNLD_D("Image CRC index built for %d frames", wNumFrames);
+
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_GetFrameCrc
+**
+** Description      Looks up the precomputed CRC16 of the image frame starting
+**                  at wOffset
+**
+** Parameters       pIndex  - index built by phDnldNfc_BuildCrcIndex
+**                  pImg    - image the frame belongs to
+**                  wOffset - offset of the frame header within the image
+**                  pCrc    - CRC16 of the frame
+**
+** Returns          NFCSTATUS_SUCCESS if found, NFCSTATUS_FAILED otherwise
+**
+*******************************************************************************/
+NFCSTATUS phDnldNfc_GetFrameCrc(pphDnldNfc_CrcIndex_t pIndex, const uint8_t *pImg, uint16_t wOffset, uint16_t *pCrc)
+{
+    uint16_t wLow = 0;
+    uint16_t wHigh;
+    uint16_t wMid;
+
+    if((NULL == pIndex) || (pImg != pIndex->pImg) || (0 == pIndex->wNumFrames))
+    {
+        return NFCSTATUS_FAILED;
+    }
+
+    wHigh = pIndex->wNumFrames;
+    while (wLow < wHigh)
+    {
+        wMid = wLow + ((wHigh - wLow) / 2);
+        if(pIndex->pOffset[wMid] < wOffset)
+        {
+            wLow = wMid + 1;
+        }
+        else
+        {
+            wHigh = wMid;
+        }
+    }
+
+    if((wLow < pIndex->wNumFrames) && (pIndex->pOffset[wLow] == wOffset))
+    {
+        *pCrc = pIndex->pCrc[wLow];
+        return NFCSTATUS_SUCCESS;
+    }
+
+    return NFCSTATUS_FAILED;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_FreeCrcIndex
+**
+** Description      Releases the memory held by an image CRC index
+**
+** Parameters       pIndex - index to release
+**
+** Returns          None
+**
+*******************************************************************************/
+void phDnldNfc_FreeCrcIndex(pphDnldNfc_CrcIndex_t pIndex)
+{
+    if(NULL != pIndex)
+    {
+        free(pIndex->pOffset);
+        free(pIndex->pCrc);
+        pIndex->pOffset = NULL;
+        pIndex->pCrc = NULL;
+        pIndex->pImg = NULL;
+        pIndex->wNumFrames = 0;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_BindCrcIndex
+**
+** Description      Checks that an index read from a file describes the frame
+**                  layout of pImg and binds it to the image, so that its CRCs
+**                  are used instead of computing them
+**
+** Parameters       pIndex - index read by phDnldNfc_LoadCrcIndex
+**                  pImg   - firmware image
+**                  wLen   - image length
+**
+** Returns          NFCSTATUS_SUCCESS if the frame offsets match the image
+**
+*******************************************************************************/
+NFCSTATUS phDnldNfc_BindCrcIndex(pphDnldNfc_CrcIndex_t pIndex, const uint8_t *pImg, uint16_t wLen)
+{
+    uint32_t dwOffset = 0;
+    uint16_t wPos;
+
+    if((NULL == pIndex) || (NULL == pImg) || (0 == pIndex->wNumFrames))
+    {
+        return NFCSTATUS_FAILED;
+    }
+
+    for (wPos = 0; wPos < pIndex->wNumFrames; wPos++)
+    {
+        if(((dwOffset + PHDNLDNFC_FRAME_HDR_LEN) > wLen) || (pIndex->pOffset[wPos] != dwOffset))
+        {
+            return NFCSTATUS_FAILED;
+        }
+        dwOffset += PHDNLDNFC_FRAME_HDR_LEN + (((uint16_t)pImg[dwOffset] << 8U) | pImg[dwOffset + 1]);
+    }
+
+    /* the next frame would not fit, as when the index is built from the image */
+    if((dwOffset > wLen) || (((dwOffset + PHDNLDNFC_FRAME_HDR_LEN) <= wLen) &&
+       ((dwOffset + PHDNLDNFC_FRAME_HDR_LEN + (((uint16_t)pImg[dwOffset] << 8U) | pImg[dwOffset + 1])) <= wLen)))
+    {
+        return NFCSTATUS_FAILED;
+    }
+
+    pIndex->pImg = pImg;
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_SaveCrcIndex
+**
+** Description      Writes a CRC index and the FW version of its image to a file
+**
+** Parameters       pIndex - index to save
+**                  wFwVer - FW version of the image
+**                  pPath  - file to write
+**
+** Returns          NFC status
+**
+*******************************************************************************/
+NFCSTATUS phDnldNfc_SaveCrcIndex(pphDnldNfc_CrcIndex_t pIndex, uint16_t wFwVer, const char *pPath)
+{
+    FILE *pFile;
+    uint8_t aEntry[4];
+    uint16_t wPos;
+    NFCSTATUS wStatus = NFCSTATUS_SUCCESS;
+
+    if((NULL == pIndex) || (0 == pIndex->wNumFrames) || (NULL == pPath))
+    {
+        return NFCSTATUS_FAILED;
+    }
+
+    pFile = fopen(pPath, "wb");
+    if(NULL == pFile)
+    {
+        NXPLOG_FWDNLD_W("Cannot create %s", pPath);
+        return NFCSTATUS_FAILED;
+    }
+
+    aEntry[0] = (uint8_t)wFwVer;
+    aEntry[1] = (uint8_t)(wFwVer >> 8U);
+    aEntry[2] = (uint8_t)(pIndex->wNumFrames);
+    aEntry[3] = (uint8_t)((pIndex->wNumFrames) >> 8U);
+    if((1 != fwrite(aCrcIdxMagic, sizeof(aCrcIdxMagic), 1, pFile)) ||
+       (1 != fwrite(aEntry, sizeof(aEntry), 1, pFile)))
+    {
+        wStatus = NFCSTATUS_FAILED;
+    }
+
+    for (wPos = 0; (wPos < pIndex->wNumFrames) && (NFCSTATUS_SUCCESS == wStatus); wPos++)
+    {
+        aEntry[0] = (uint8_t)(pIndex->pOffset[wPos]);
+        aEntry[1] = (uint8_t)((pIndex->pOffset[wPos]) >> 8U);
+        aEntry[2] = (uint8_t)(pIndex->pCrc[wPos]);
+        aEntry[3] = (uint8_t)((pIndex->pCrc[wPos]) >> 8U);
+        if(1 != fwrite(aEntry, sizeof(aEntry), 1, pFile))
+        {
+            wStatus = NFCSTATUS_FAILED;
+        }
+    }
+
+    if((0 != fclose(pFile)) || (NFCSTATUS_SUCCESS != wStatus))
+    {
+        NXPLOG_FWDNLD_W("Cannot write %s", pPath);
+        (void)remove(pPath);
+        wStatus = NFCSTATUS_FAILED;
+    }
+
+    return wStatus;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_LoadCrcIndex
+**
+** Description      Reads a CRC index written by phDnldNfc_SaveCrcIndex. The
+**                  index is not bound to an image.
+**
+** Parameters       pIndex - index to fill, previous content is released
+**                  pFwVer - FW version of the image the index was built for
+**                  pPath  - file to read
+**
+** Returns          NFC status
+**
+*******************************************************************************/
+NFCSTATUS phDnldNfc_LoadCrcIndex(pphDnldNfc_CrcIndex_t pIndex, uint16_t *pFwVer, const char *pPath)
+{
+    FILE *pFile;
+    uint8_t aHdr[PHDNLDNFC_CRCIDX_HDR_LEN];
+    uint8_t aEntry[4];
+    uint16_t wNumFrames;
+    uint16_t wPos;
+    NFCSTATUS wStatus = NFCSTATUS_SUCCESS;
+
+    if((NULL == pIndex) || (NULL == pFwVer) || (NULL == pPath))
+    {
+        return NFCSTATUS_FAILED;
+    }
+
+    phDnldNfc_FreeCrcIndex(pIndex);
+
+    pFile = fopen(pPath, "rb");
+    if(NULL == pFile)
+    {
+        return NFCSTATUS_FAILED;
+    }
+
+    if((1 != fread(aHdr, sizeof(aHdr), 1, pFile)) ||
+       (0 != memcmp(aHdr, aCrcIdxMagic, sizeof(aCrcIdxMagic))))
+    {
+        fclose(pFile);
+        NXPLOG_FWDNLD_W("%s is not a CRC index", pPath);
+        return NFCSTATUS_FAILED;
+    }
+
+    *pFwVer = (((uint16_t)aHdr[5] << 8U) | aHdr[4]);
+    wNumFrames = (((uint16_t)aHdr[7] << 8U) | aHdr[6]);
+
+    pIndex->pOffset = (uint16_t *)malloc(wNumFrames * sizeof(uint16_t));
+    pIndex->pCrc = (uint16_t *)malloc(wNumFrames * sizeof(uint16_t));
+    if((0 == wNumFrames) || (NULL == pIndex->pOffset) || (NULL == pIndex->pCrc))
+    {
+        wStatus = NFCSTATUS_FAILED;
+    }
+
+    for (wPos = 0; (wPos < wNumFrames) && (NFCSTATUS_SUCCESS == wStatus); wPos++)
+    {
+        if(1 != fread(aEntry, sizeof(aEntry), 1, pFile))
+        {
+            wStatus = NFCSTATUS_FAILED;
+            break;
+        }
+        pIndex->pOffset[wPos] = (((uint16_t)aEntry[1] << 8U) | aEntry[0]);
+        pIndex->pCrc[wPos] = (((uint16_t)aEntry[3] << 8U) | aEntry[2]);
+
+        /* offsets have to be increasing for the lookup */
+        if((0 != wPos) && (pIndex->pOffset[wPos] <= pIndex->pOffset[wPos - 1]))
+        {
+            wStatus = NFCSTATUS_FAILED;
+        }
+    }
+
+    if((NFCSTATUS_SUCCESS == wStatus) && (EOF != fgetc(pFile)))
+    {
+        wStatus = NFCSTATUS_FAILED;
+    }
+    fclose(pFile);
+
+    if(NFCSTATUS_SUCCESS != wStatus)
+    {
+        NXPLOG_FWDNLD_W("%s is not a valid CRC index", pPath);
+        phDnldNfc_FreeCrcIndex(pIndex);
+        return NFCSTATUS_FAILED;
+    }
+
+    pIndex->wNumFrames = wNumFrames;
+    return NFCSTATUS_SUCCESS;
+}
@@ -22,6 +22,25 @@
 
 #include <phDnldNfc.h>
 
+/*
+ * CRC16 of each frame of a firmware image, computed once when the image is loaded
+ * or read from a file written by phDnldNfc_SaveCrcIndex
+ */
+typedef struct phDnldNfc_CrcIndex
+{
+    const uint8_t *pImg;         /* Image the index was built for */
+    uint16_t  wNumFrames;        /* Number of frames in the image */
+    uint16_t  *pOffset;          /* Offset of each frame within the image */
+    uint16_t  *pCrc;             /* CRC16 of each frame (header + payload) */
+}phDnldNfc_CrcIndex_t, *pphDnldNfc_CrcIndex_t;
+
 extern uint16_t phDnldNfc_CalcCrc16(uint8_t* pBuff, uint16_t wLen);
+extern NFCSTATUS phDnldNfc_BuildCrcIndex(pphDnldNfc_CrcIndex_t pIndex, const uint8_t *pImg, uint16_t wLen);
+extern NFCSTATUS phDnldNfc_GetFrameCrc(pphDnldNfc_CrcIndex_t pIndex, const uint8_t *pImg, uint16_t wOffset, uint16_t *pCrc);
+extern void phDnldNfc_FreeCrcIndex(pphDnldNfc_CrcIndex_t pIndex);
+extern NFCSTATUS phDnldNfc_BindCrcIndex(pphDnldNfc_CrcIndex_t pIndex, const uint8_t *pImg, uint16_t wLen);
+extern NFCSTATUS phDnldNfc_SaveCrcIndex(pphDnldNfc_CrcIndex_t pIndex, uint16_t wFwVer, const char *pPath);
+extern NFCSTATUS phDnldNfc_LoadCrcIndex(pphDnldNfc_CrcIndex_t pIndex, uint16_t *pFwVer, const char *pPath);
+extern uint32_t phDnldNfc_GetTimeMs(void);
 
 #endif /* PHDNLDNFC_UTILS_H */
@@ -55,15 +55,53 @@ extern int kovio_detected;
 extern int disable_kovio;
 static uint8_t Rx_data[NCI_MAX_DATA_LEN];
 
+/* Queue of NCI data packets being written without blocking the caller */
+static phNxpNciHal_TxQueue_t tx_queue = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+/* Proprietary core initialization commands */
+static phNxpNciHal_InitPlan_t init_plan;
+static const struct
+{
+    const char *p_name;
+    uint8_t     stage;
+    const char *p_err;
+} init_plan_entries[] =
+{
+    { NAME_NXP_ACT_PROP_EXTN,       INIT_STAGE_PROP_EXTN, "NXP ACT Proprietary Ext failed" },
+    { NAME_NXP_NFC_PROFILE_EXTN,    INIT_STAGE_PROFILE,   "NXP ACT Proprietary Ext failed" },
+    { NAME_NXP_RF_CONF_BLK_1,       INIT_STAGE_RF_CONF,   "RF Settings BLK 1 failed" },
+    { NAME_NXP_RF_CONF_BLK_2,       INIT_STAGE_RF_CONF,   "RF Settings BLK 2 failed" },
+    { NAME_NXP_RF_CONF_BLK_3,       INIT_STAGE_RF_CONF,   "RF Settings BLK 3 failed" },
+    { NAME_NXP_RF_CONF_BLK_4,       INIT_STAGE_RF_CONF,   "RF Settings BLK 4 failed" },
+    { NAME_NXP_RF_CONF_BLK_5,       INIT_STAGE_RF_CONF,   "RF Settings BLK 5 failed" },
+    { NAME_NXP_RF_CONF_BLK_6,       INIT_STAGE_RF_CONF,   "RF Settings BLK 6 failed" },
+    { NAME_NXP_CORE_CONF_EXTN,      INIT_STAGE_RF_CONF,   "NXP Core configuration failed" },
+    { NAME_NXP_CORE_MFCKEY_SETTING, INIT_STAGE_RF_CONF,   "Setting mifare keys failed" },
+    { NAME_NXP_CORE_STANDBY,        INIT_STAGE_CORE_CONF, "Stand by mode enable failed" },
+    { NAME_NXP_CORE_CONF,           INIT_STAGE_CORE_CONF, "Core Set Config failed" }
+};
+
 uint32_t timeoutTimerId = 0;
 
 /**************** local methods used in this file only ************************/
 static NFCSTATUS phNxpNciHal_fw_download(void);
 static void phNxpNciHal_open_complete(NFCSTATUS status);
 static void phNxpNciHal_write_complete(void *pContext, phTmlNfc_TransactInfo_t *pInfo);
+static void phNxpNciHal_write_recover(void);
+static int  phNxpNciHal_tx_enqueue(uint16_t data_len, const uint8_t *p_data);
+static void phNxpNciHal_tx_submit(void);
+static void phNxpNciHal_tx_complete(void *pContext, phTmlNfc_TransactInfo_t *pInfo);
+static void phNxpNciHal_tx_acquire(void);
+static void phNxpNciHal_tx_release(void);
+static void phNxpNciHal_tx_flush(void);
 static void phNxpNciHal_read_complete(void *pContext, phTmlNfc_TransactInfo_t *pInfo);
 static void phNxpNciHal_close_complete(NFCSTATUS status);
 static void phNxpNciHal_core_initialized_complete(NFCSTATUS status);
+static void phNxpNciHal_init_plan_build(void);
+static void phNxpNciHal_init_plan_add(uint8_t stage, const char *p_err,
+        const uint8_t *p_cmd, uint16_t cmd_len);
+static uint32_t phNxpNciHal_init_plan_hash(uint8_t stage);
+static NFCSTATUS phNxpNciHal_init_plan_send(uint8_t stage);
 static void phNxpNciHal_pre_discover_complete(NFCSTATUS status);
 static void phNxpNciHal_power_cycle_complete(NFCSTATUS status);
 static void phNxpNciHal_kill_client_thread(phNxpNciHal_Control_t *p_nxpncihal_ctrl);
@@ -398,7 +436,7 @@ int phNxpNciHal_open(nfc_stack_callback_t *p_cback, nfc_stack_data_callback_t *p
 
     /* call read pending */
     status = phTmlNfc_Read(
-            nxpncihal_ctrl.p_cmd_data,
+            Rx_data,
             NCI_MAX_DATA_LEN,
             (pphTmlNfc_TransactCompletionCb_t) &phNxpNciHal_read_complete,
             NULL);
@@ -467,7 +505,7 @@ force_download:
             fw_download_success = 1;
             /* call read pending */
             status = phTmlNfc_Read(
-                    nxpncihal_ctrl.p_cmd_data,
+                    Rx_data,
                     NCI_MAX_DATA_LEN,
                     (pphTmlNfc_TransactCompletionCb_t) &phNxpNciHal_read_complete,
                     NULL);
@@ -583,6 +621,17 @@ int phNxpNciHal_write(uint16_t data_len, const uint8_t *p_data)
         goto clean_and_return;
     }
 
+    /* NCI data packets are queued and written in the background; the stack
+     * only sends them against connection credits, so they need no response
+     * handling here. ISO 15693 frames that need an EOF stay synchronous. */
+    if (((nxpncihal_ctrl.p_cmd_data[0] & 0xE0) == 0x00) &&
+        (icode_send_eof != 1))
+    {
+        data_len = phNxpNciHal_tx_enqueue(nxpncihal_ctrl.cmd_len,
+                nxpncihal_ctrl.p_cmd_data);
+        goto clean_and_return;
+    }
+
     CONCURRENCY_LOCK();
     data_len = phNxpNciHal_write_unlocked(nxpncihal_ctrl.cmd_len,
             nxpncihal_ctrl.p_cmd_data);
@@ -605,7 +654,8 @@ int phNxpNciHal_write(uint16_t data_len, const uint8_t *p_data)
  *
  * Description      This is the actual function which is being called by
  *                  phNxpNciHal_write. This function writes the data to NFCC.
- *                  It waits till write callback provide the result of write
+ *                  It waits for queued data packets to be written first and
+ *                  then till write callback provide the result of write
  *                  process.
  *
  * Returns          It returns number of bytes successfully written to NFCC.
@@ -616,16 +666,17 @@ int phNxpNciHal_write_unlocked(uint16_t data_len, const uint8_t *p_data)
     NFCSTATUS status = NFCSTATUS_INVALID_PARAMETER;
     phNxpNciHal_Sem_t cb_data;
     nxpncihal_ctrl.retry_cnt = 0;
-    static uint8_t reset_ntf[] = {0x60, 0x00, 0x06, 0xA0, 0x00, 0xC7, 0xD4, 0x00, 0x00};
 
     /* Create the local semaphore */
     if (phNxpNciHal_init_cb_data(&cb_data, NULL) != NFCSTATUS_SUCCESS)
     {
         NXPLOG_NCIHAL_D("phNxpNciHal_write_unlocked Create cb data failed");
-        data_len = 0;
-        goto clean_and_return;
+        return 0;
     }
 
+    /* Take the TML writer once the write queue has drained */
+    phNxpNciHal_tx_acquire();
+
     /* Create local copy of cmd_data */
     memcpy(nxpncihal_ctrl.p_cmd_data, p_data, data_len);
     nxpncihal_ctrl.cmd_len = data_len;
@@ -666,34 +717,242 @@ int phNxpNciHal_write_unlocked(uint16_t data_len, const uint8_t *p_data)
 
             NXPLOG_NCIHAL_E("write_unlocked failed - PN547 Maybe in Standby Mode (max count = 0x%x)", nxpncihal_ctrl.retry_cnt);
 
-            status = phTmlNfc_IoCtl(phTmlNfc_e_ResetDevice);
-
-            if(NFCSTATUS_SUCCESS == status)
-            {
-                NXPLOG_NCIHAL_D("PN547 Reset - SUCCESS\n");
-            }
-            else
-            {
-                NXPLOG_NCIHAL_D("PN547 Reset - FAILED\n");
-            }
-            if (nxpncihal_ctrl.p_nfc_stack_data_cback!= NULL &&
-                nxpncihal_ctrl.p_rx_data!= NULL &&
-                nxpncihal_ctrl.hal_open_status == TRUE)
-            {
-                NXPLOG_NCIHAL_D("Send the Core Reset NTF to upper layer, which will trigger the recovery\n");
-                //Send the Core Reset NTF to upper layer, which will trigger the recovery.
-                nxpncihal_ctrl.rx_data_len = sizeof(reset_ntf);
-                memcpy(nxpncihal_ctrl.p_rx_data, reset_ntf, sizeof(reset_ntf));
-                (*nxpncihal_ctrl.p_nfc_stack_data_cback)(nxpncihal_ctrl.rx_data_len, nxpncihal_ctrl.p_rx_data);
-            }
+            phNxpNciHal_write_recover();
         }
     }
 
     clean_and_return:
+    phNxpNciHal_tx_release();
     phNxpNciHal_cleanup_cb_data(&cb_data);
     return data_len;
 }
 
+/******************************************************************************
+ * Function         phNxpNciHal_write_recover
+ *
+ * Description      This function resets PN547 after repeated write failures
+ *                  and sends a CORE_RESET_NTF to libnfc-nci, which will
+ *                  trigger the recovery.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_write_recover(void)
+{
+    NFCSTATUS status;
+    static uint8_t reset_ntf[] = {0x60, 0x00, 0x06, 0xA0, 0x00, 0xC7, 0xD4, 0x00, 0x00};
+
+    /* Packets exchanged before the failure */
+    phNxpNciHal_trace_recovery();
+
+    status = phTmlNfc_IoCtl(phTmlNfc_e_ResetDevice);
+
+    if(NFCSTATUS_SUCCESS == status)
+    {
+        NXPLOG_NCIHAL_D("PN547 Reset - SUCCESS\n");
+    }
+    else
+    {
+        NXPLOG_NCIHAL_D("PN547 Reset - FAILED\n");
+    }
+    if (nxpncihal_ctrl.p_nfc_stack_data_cback!= NULL &&
+        nxpncihal_ctrl.p_rx_data!= NULL &&
+        nxpncihal_ctrl.hal_open_status == TRUE)
+    {
+        NXPLOG_NCIHAL_D("Send the Core Reset NTF to upper layer, which will trigger the recovery\n");
+        //Send the Core Reset NTF to upper layer, which will trigger the recovery.
+        nxpncihal_ctrl.rx_data_len = sizeof(reset_ntf);
+        memcpy(nxpncihal_ctrl.p_rx_data, reset_ntf, sizeof(reset_ntf));
+        (*nxpncihal_ctrl.p_nfc_stack_data_cback)(nxpncihal_ctrl.rx_data_len, nxpncihal_ctrl.p_rx_data);
+    }
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_tx_enqueue
+ *
+ * Description      This function copies an NCI data packet into the write
+ *                  queue and starts writing it if the TML writer is idle.
+ *                  It only blocks when all queue slots are in use.
+ *
+ * Returns          It returns number of bytes accepted for writing.
+ *
+ ******************************************************************************/
+static int phNxpNciHal_tx_enqueue(uint16_t data_len, const uint8_t *p_data)
+{
+    phNxpNciHal_TxSlot_t *p_slot;
+
+    pthread_mutex_lock(&tx_queue.lock);
+    while (tx_queue.count == NXP_NCIHAL_TX_QUEUE_DEPTH)
+    {
+        tx_queue.full_waits++;
+        pthread_cond_wait(&tx_queue.cond, &tx_queue.lock);
+    }
+
+    p_slot = &tx_queue.slots[(tx_queue.head + tx_queue.count) & (NXP_NCIHAL_TX_QUEUE_DEPTH - 1)];
+    memcpy(p_slot->p_data, p_data, data_len);
+    p_slot->len = data_len;
+    p_slot->retry_cnt = 0;
+    tx_queue.count++;
+
+    if (!tx_queue.busy)
+    {
+        phNxpNciHal_tx_submit();
+    }
+    pthread_mutex_unlock(&tx_queue.lock);
+
+    return data_len;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_tx_submit
+ *
+ * Description      This function hands the oldest queued packet to TML.
+ *                  Packets TML refuses are dropped. Must be called with
+ *                  tx_queue.lock held.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_tx_submit(void)
+{
+    phNxpNciHal_TxSlot_t *p_slot;
+    NFCSTATUS status;
+
+    while (tx_queue.count > 0)
+    {
+        p_slot = &tx_queue.slots[tx_queue.head];
+        status = phTmlNfc_Write(p_slot->p_data, p_slot->len,
+                (pphTmlNfc_TransactCompletionCb_t) &phNxpNciHal_tx_complete,
+                (void *) p_slot);
+        if (status == NFCSTATUS_PENDING)
+        {
+            tx_queue.busy = TRUE;
+            return;
+        }
+
+        NXPLOG_NCIHAL_E("tx queue write status error = 0x%x", status);
+        tx_queue.head = (tx_queue.head + 1) & (NXP_NCIHAL_TX_QUEUE_DEPTH - 1);
+        tx_queue.count--;
+    }
+
+    tx_queue.busy = FALSE;
+    pthread_cond_broadcast(&tx_queue.cond);
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_tx_complete
+ *
+ * Description      This function handles write callback of a queued packet.
+ *                  A failed write is retried like in phNxpNciHal_write_unlocked;
+ *                  otherwise the slot is released and the next packet sent.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_tx_complete(void *pContext, phTmlNfc_TransactInfo_t *pInfo)
+{
+    phNxpNciHal_TxSlot_t *p_slot = (phNxpNciHal_TxSlot_t *) pContext;
+    NFCSTATUS status;
+
+    if (pInfo->wStatus == NFCSTATUS_SUCCESS)
+    {
+        NXPLOG_NCIHAL_D("write successful status = 0x%x", pInfo->wStatus);
+    }
+    else if (p_slot->retry_cnt++ < MAX_RETRY_COUNT)
+    {
+        NXPLOG_NCIHAL_E("tx queue write failed - PN547 Maybe in Standby Mode - Retry");
+        /* 1ms delay to give NFCC wake up delay */
+        usleep(1000);
+        pthread_mutex_lock(&tx_queue.lock);
+        status = phTmlNfc_Write(p_slot->p_data, p_slot->len,
+                (pphTmlNfc_TransactCompletionCb_t) &phNxpNciHal_tx_complete,
+                (void *) p_slot);
+        pthread_mutex_unlock(&tx_queue.lock);
+        if (status == NFCSTATUS_PENDING)
+        {
+            return;
+        }
+        NXPLOG_NCIHAL_E("tx queue retry status error = 0x%x", status);
+    }
+    else
+    {
+        NXPLOG_NCIHAL_E("tx queue write failed - PN547 Maybe in Standby Mode (max count = 0x%x)", p_slot->retry_cnt);
+        /* Whatever is still queued belongs to the session being reset */
+        phNxpNciHal_tx_flush();
+        phNxpNciHal_write_recover();
+        return;
+    }
+
+    pthread_mutex_lock(&tx_queue.lock);
+    tx_queue.head = (tx_queue.head + 1) & (NXP_NCIHAL_TX_QUEUE_DEPTH - 1);
+    tx_queue.count--;
+    phNxpNciHal_tx_submit();
+    pthread_mutex_unlock(&tx_queue.lock);
+
+    return;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_tx_acquire
+ *
+ * Description      This function waits until all queued packets are written
+ *                  and reserves the TML writer for a synchronous write.
+ *                  Must not be called from the client thread.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_tx_acquire(void)
+{
+    pthread_mutex_lock(&tx_queue.lock);
+    while (tx_queue.busy || (tx_queue.count > 0))
+    {
+        pthread_cond_wait(&tx_queue.cond, &tx_queue.lock);
+    }
+    tx_queue.busy = TRUE;
+    pthread_mutex_unlock(&tx_queue.lock);
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_tx_release
+ *
+ * Description      This function ends a synchronous write and resumes writing
+ *                  packets queued meanwhile.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_tx_release(void)
+{
+    pthread_mutex_lock(&tx_queue.lock);
+    phNxpNciHal_tx_submit();
+    pthread_mutex_unlock(&tx_queue.lock);
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_tx_flush
+ *
+ * Description      This function drops all queued packets and wakes up any
+ *                  writer waiting on the queue.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_tx_flush(void)
+{
+    pthread_mutex_lock(&tx_queue.lock);
+    if (tx_queue.full_waits)
+    {
+        NXPLOG_NCIHAL_D("tx queue was full %u times", tx_queue.full_waits);
+    }
+    tx_queue.head = 0;
+    tx_queue.count = 0;
+    tx_queue.busy = FALSE;
+    tx_queue.full_waits = 0;
+    pthread_cond_broadcast(&tx_queue.cond);
+    pthread_mutex_unlock(&tx_queue.lock);
+}
+
 /******************************************************************************
  * Function         phNxpNciHal_write_complete
  *
@@ -823,31 +1082,12 @@ int phNxpNciHal_core_initialized(uint8_t* p_core_init_rsp_params)
     NFCSTATUS status = NFCSTATUS_SUCCESS;
     static uint8_t p2p_listen_mode_routing_cmd[] = { 0x21, 0x01, 0x07, 0x00, 0x01,
                                                 0x01, 0x03, 0x00, 0x01, 0x05 };
+    uint32_t rf_conf_hash;
 
-    uint8_t swp_full_pwr_mode_on_cmd[] = { 0x20, 0x02, 0x05, 0x01, 0xA0,
-                                           0xF1,0x01,0x01 };
-
-    uint8_t *buffer = NULL;
-    long bufflen = 260;
-    long retlen = 0;
-    int isfound;
+    phNxpNciHal_init_plan_build();
 
-    buffer = (uint8_t*) malloc(bufflen*sizeof(uint8_t));
-    if(NULL == buffer)
-    {
-        return NFCSTATUS_FAILED;
-    }
-
-    retlen = 0;
-    isfound = GetNxpByteArrayValue(NAME_NXP_ACT_PROP_EXTN, (char *) buffer,
-            bufflen, &retlen);
-    if (retlen > 0) {
-        /* NXP ACT Proprietary Ext */
-        status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-        if (status != NFCSTATUS_SUCCESS) {
-            NXPLOG_NCIHAL_E("NXP ACT Proprietary Ext failed");
-        }
-    }
+    /* NXP ACT Proprietary Ext */
+    phNxpNciHal_init_plan_send(INIT_STAGE_PROP_EXTN);
 #ifdef PN547C2_CLOCK_SETTING
     if (fw_download_success == 1)
     {
@@ -855,173 +1095,219 @@ int phNxpNciHal_core_initialized(uint8_t* p_core_init_rsp_params)
     }
 #endif
     phNxpNciHal_check_factory_reset();
-    retlen = 0;
-    isfound = GetNxpByteArrayValue(NAME_NXP_NFC_PROFILE_EXTN, (char *) buffer,
-            bufflen, &retlen);
-    if (retlen > 0) {
-        /* NXP ACT Proprietary Ext */
-        status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-        if (status != NFCSTATUS_SUCCESS) {
-            NXPLOG_NCIHAL_E("NXP ACT Proprietary Ext failed");
-        }
-    }
+    phNxpNciHal_init_plan_send(INIT_STAGE_PROFILE);
 
-    if(isNxpConfigModified() || (fw_download_success == 1))
+    /* RF settings survive an NFC toggle; only resend them when the firmware
+     * or their content changed since they were last applied */
+    rf_conf_hash = phNxpNciHal_init_plan_hash(INIT_STAGE_RF_CONF);
+    if((fw_download_success == 1) ||
+        isNxpInitStateModified(wFwVerRsp, rf_conf_hash))
     {
-
-        retlen = 0;
         fw_download_success = 0;
-        NXPLOG_NCIHAL_D ("Performing RF Settings BLK 1");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_1, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-            if (status != NFCSTATUS_SUCCESS) {
-                NXPLOG_NCIHAL_E("RF Settings BLK 1 failed");
-            }
+        NXPLOG_NCIHAL_D ("Performing RF Settings");
+        if (phNxpNciHal_init_plan_send(INIT_STAGE_RF_CONF) == NFCSTATUS_SUCCESS)
+        {
+            updateNxpInitState(wFwVerRsp, rf_conf_hash);
         }
-        retlen = 0;
+    }
+    else
+    {
+        NXPLOG_NCIHAL_D ("RF Settings unchanged, skipped");
+    }
 
-        NXPLOG_NCIHAL_D ("Performing RF Settings BLK 2");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_2, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-            if (status != NFCSTATUS_SUCCESS) {
-                NXPLOG_NCIHAL_E("RF Settings BLK 2 failed");
-            }
-        }
-        retlen = 0;
+    phNxpNciHal_init_plan_send(INIT_STAGE_CORE_CONF);
 
-        NXPLOG_NCIHAL_D ("Performing RF Settings BLK 3");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_3, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-            if (status != NFCSTATUS_SUCCESS) {
-                NXPLOG_NCIHAL_E("RF Settings BLK 3 failed");
-            }
-        }
-        retlen = 0;
+    /* P2P listen mode routing */
+    status = phNxpNciHal_send_ext_cmd (sizeof (p2p_listen_mode_routing_cmd), p2p_listen_mode_routing_cmd);
+    if (status != NFCSTATUS_SUCCESS)
+    {
+        NXPLOG_NCIHAL_E("P2P listen mode routing failed");
+    }
 
-        NXPLOG_NCIHAL_D ("Performing RF Settings BLK 4");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_4, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-            if (status != NFCSTATUS_SUCCESS) {
-                NXPLOG_NCIHAL_E("RF Settings BLK 4 failed");
-            }
-        }
-        retlen = 0;
+    /* SWP full power mode, kept after the listen mode routing as before */
+    phNxpNciHal_init_plan_send(INIT_STAGE_SWP_PWR);
 
-        NXPLOG_NCIHAL_D ("Performing RF Settings BLK 5");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_5, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-            if (status != NFCSTATUS_SUCCESS) {
-                NXPLOG_NCIHAL_E("RF Settings BLK 5 failed");
-            }
-        }
-        retlen = 0;
+    phNxpNciHal_core_initialized_complete(status);
 
-        NXPLOG_NCIHAL_D ("Performing RF Settings BLK 6");
-        isfound = GetNxpByteArrayValue(NAME_NXP_RF_CONF_BLK_6, (char *) buffer,
-                bufflen, &retlen);
-        if (retlen > 0) {
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-            if (status != NFCSTATUS_SUCCESS) {
-                NXPLOG_NCIHAL_E("RF Settings BLK 6 failed");
-            }
-        }
-        retlen = 0;
+    return NFCSTATUS_SUCCESS;
+}
 
-        isfound = GetNxpByteArrayValue(NAME_NXP_CORE_CONF_EXTN,
-                (char *) buffer, bufflen, &retlen);
-        if (retlen > 0) {
-            /* NXP ACT Proprietary Ext */
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-            if (status != NFCSTATUS_SUCCESS) {
-                NXPLOG_NCIHAL_E("NXP Core configuration failed");
-            }
-        }
+/******************************************************************************
+ * Function         phNxpNciHal_init_plan_build
+ *
+ * Description      This function parses all proprietary settings sent by
+ *                  phNxpNciHal_core_initialized from the config file into
+ *                  init_plan, so the config is walked once per initialization
+ *                  and adjacent CORE_SET_CONFIG commands can be merged.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_init_plan_build(void)
+{
+    uint8_t swp_full_pwr_mode_on_cmd[] = { 0x20, 0x02, 0x05, 0x01, 0xA0,
+                                           0xF1,0x01,0x01 };
+    long retlen;
+    uint8_t i;
 
-        retlen = 0;
+    init_plan.used = 0;
+    init_plan.count = 0;
 
-        isfound = GetNxpByteArrayValue(NAME_NXP_CORE_MFCKEY_SETTING,
-                (char *) buffer, bufflen, &retlen);
-        if (retlen > 0) {
-            /* NXP ACT Proprietary Ext */
-            status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-            if (status != NFCSTATUS_SUCCESS) {
-                NXPLOG_NCIHAL_E("Setting mifare keys failed");
-            }
+    for (i = 0; i < sizeof(init_plan_entries) / sizeof(init_plan_entries[0]); i++)
+    {
+        retlen = 0;
+        GetNxpByteArrayValue(init_plan_entries[i].p_name,
+                (char *) &init_plan.buf[init_plan.used],
+                NXP_NCIHAL_INIT_PLAN_SIZE - init_plan.used, &retlen);
+        if (retlen > 0)
+        {
+            phNxpNciHal_init_plan_add(init_plan_entries[i].stage,
+                    init_plan_entries[i].p_err,
+                    &init_plan.buf[init_plan.used], (uint16_t) retlen);
         }
     }
 
+    /* SWP FULL PWR MODE SETTING ON */
     retlen = 0;
-
-    isfound = GetNxpByteArrayValue(NAME_NXP_CORE_STANDBY, (char *) buffer,bufflen, &retlen);
-    if (retlen > 0) {
-        /* NXP ACT Proprietary Ext */
-        status = phNxpNciHal_send_ext_cmd(retlen, buffer);
-        if (status != NFCSTATUS_SUCCESS) {
-            NXPLOG_NCIHAL_E("Stand by mode enable failed");
+    if(GetNxpNumValue(NAME_NXP_SWP_FULL_PWR_ON, (void *)&retlen, sizeof(retlen)))
+    {
+        if(1 == retlen)
+        {
+            phNxpNciHal_init_plan_add(INIT_STAGE_SWP_PWR,
+                    "SWP FULL PWR MODE SETTING ON CMD FAILED",
+                    swp_full_pwr_mode_on_cmd, sizeof(swp_full_pwr_mode_on_cmd));
+        }
+        else
+        {
+            swp_full_pwr_mode_on_cmd[7]=0x00;
+            phNxpNciHal_init_plan_add(INIT_STAGE_SWP_PWR,
+                    "SWP FULL PWR MODE SETTING OFF CMD FAILED",
+                    swp_full_pwr_mode_on_cmd, sizeof(swp_full_pwr_mode_on_cmd));
         }
     }
-    retlen = 0;
+}
 
-    isfound =  GetNxpByteArrayValue(NAME_NXP_CORE_CONF,(char *)buffer,bufflen,&retlen);
-    if(retlen > 0)
+/******************************************************************************
+ * Function         phNxpNciHal_init_plan_add
+ *
+ * Description      This function appends a command to init_plan. A
+ *                  CORE_SET_CONFIG following another one of the same stage
+ *                  is folded into it as long as the merged payload fits in a
+ *                  single control packet, saving one command/response round
+ *                  trip.
+ *
+ * Returns          void.
+ *
+ ******************************************************************************/
+static void phNxpNciHal_init_plan_add(uint8_t stage, const char *p_err,
+        const uint8_t *p_cmd, uint16_t cmd_len)
+{
+    phNxpNciHal_InitCmd_t *p_prev = NULL;
+    uint8_t *p_last;
+
+    if ((init_plan.count == NXP_NCIHAL_INIT_PLAN_CMDS) ||
+        (cmd_len > NXP_NCIHAL_INIT_PLAN_SIZE - init_plan.used))
     {
-        /* NXP ACT Proprietary Ext */
-        status = phNxpNciHal_send_ext_cmd(retlen,buffer);
-        if (status != NFCSTATUS_SUCCESS)
-        {
-            NXPLOG_NCIHAL_E("Core Set Config failed");
-        }
+        NXPLOG_NCIHAL_E("Init plan full, dropping: %s", p_err);
+        return;
     }
+    if (p_cmd != &init_plan.buf[init_plan.used])
+    {
+        memcpy(&init_plan.buf[init_plan.used], p_cmd, cmd_len);
+    }
+    p_cmd = &init_plan.buf[init_plan.used];
 
-    /* P2P listen mode routing */
-    status = phNxpNciHal_send_ext_cmd (sizeof (p2p_listen_mode_routing_cmd), p2p_listen_mode_routing_cmd);
-    if (status != NFCSTATUS_SUCCESS)
+    if (init_plan.count > 0)
     {
-        NXPLOG_NCIHAL_E("P2P listen mode routing failed");
+        p_prev = &init_plan.cmds[init_plan.count - 1];
+        p_last = &init_plan.buf[p_prev->offset];
+        if ((p_prev->stage == stage) &&
+            (cmd_len > 4) && (p_cmd[0] == 0x20) && (p_cmd[1] == 0x02) &&
+            (p_cmd[2] == cmd_len - 3) &&
+            (p_last[0] == 0x20) && (p_last[1] == 0x02) &&
+            (p_last[2] == p_prev->len - 3) &&
+            (p_last[2] + cmd_len - 4 <= 0xFF) &&
+            (p_last[3] + p_cmd[3] <= 0xFF))
+        {
+            /* Drop the header and append the TLVs to the previous command */
+            p_last[2] += cmd_len - 4;
+            p_last[3] += p_cmd[3];
+            memmove(&init_plan.buf[init_plan.used], &p_cmd[4], cmd_len - 4);
+            p_prev->len += cmd_len - 4;
+            init_plan.used += cmd_len - 4;
+            return;
+        }
     }
 
-    retlen = 0;
+    init_plan.cmds[init_plan.count].offset = init_plan.used;
+    init_plan.cmds[init_plan.count].len = cmd_len;
+    init_plan.cmds[init_plan.count].stage = stage;
+    init_plan.cmds[init_plan.count].p_err = p_err;
+    init_plan.count++;
+    init_plan.used += cmd_len;
+}
 
-    /* SWP FULL PWR MODE SETTING ON */
-    if(GetNxpNumValue(NAME_NXP_SWP_FULL_PWR_ON, (void *)&retlen, sizeof(retlen)))
+/******************************************************************************
+ * Function         phNxpNciHal_init_plan_hash
+ *
+ * Description      This function computes a FNV-1a hash over the commands of
+ *                  a stage of init_plan.
+ *
+ * Returns          Hash value.
+ *
+ ******************************************************************************/
+static uint32_t phNxpNciHal_init_plan_hash(uint8_t stage)
+{
+    uint32_t hash = 0x811C9DC5;
+    uint16_t i, j;
+
+    for (i = 0; i < init_plan.count; i++)
     {
-        if(1 == retlen)
+        if (init_plan.cmds[i].stage != stage)
         {
-            status = phNxpNciHal_send_ext_cmd (sizeof(swp_full_pwr_mode_on_cmd),
-                                                      swp_full_pwr_mode_on_cmd);
-            if (status != NFCSTATUS_SUCCESS)
-            {
-               NXPLOG_NCIHAL_E("SWP FULL PWR MODE SETTING ON CMD FAILED");
-            }
+            continue;
         }
-        else
+        for (j = 0; j < init_plan.cmds[i].len; j++)
         {
-            swp_full_pwr_mode_on_cmd[7]=0x00;
-            status = phNxpNciHal_send_ext_cmd (sizeof(swp_full_pwr_mode_on_cmd),
-                                                      swp_full_pwr_mode_on_cmd);
-            if (status != NFCSTATUS_SUCCESS)
-            {
-                NXPLOG_NCIHAL_E("SWP FULL PWR MODE SETTING OFF CMD FAILED");
-            }
+            hash ^= init_plan.buf[init_plan.cmds[i].offset + j];
+            hash *= 0x01000193;
         }
     }
-    if(buffer)
+
+    return hash;
+}
+
+/******************************************************************************
+ * Function         phNxpNciHal_init_plan_send
+ *
+ * Description      This function sends the commands of a stage of init_plan.
+ *
+ * Returns          NFCSTATUS_SUCCESS if all commands succeeded, otherwise the
+ *                  status of the last failed command.
+ *
+ ******************************************************************************/
+static NFCSTATUS phNxpNciHal_init_plan_send(uint8_t stage)
+{
+    NFCSTATUS status = NFCSTATUS_SUCCESS;
+    NFCSTATUS cmd_status;
+    uint8_t i;
+
+    for (i = 0; i < init_plan.count; i++)
     {
-        free(buffer);
+        if (init_plan.cmds[i].stage != stage)
+        {
+            continue;
+        }
+        cmd_status = phNxpNciHal_send_ext_cmd(init_plan.cmds[i].len,
+                &init_plan.buf[init_plan.cmds[i].offset]);
+        if (cmd_status != NFCSTATUS_SUCCESS)
+        {
+            NXPLOG_NCIHAL_E("%s", init_plan.cmds[i].p_err);
+            status = cmd_status;
+        }
     }
-    phNxpNciHal_core_initialized_complete(status);
 
-    return NFCSTATUS_SUCCESS;
+    return status;
 }
 
 /******************************************************************************
@@ -1147,6 +1433,9 @@ int phNxpNciHal_close(void)
 
         status = phTmlNfc_Shutdown();
 
+        /* Writes still queued can no longer complete */
+        phNxpNciHal_tx_flush();
+
         phDal4Nfc_msgrelease(nxpncihal_ctrl.gDrvCfg.nClientId);
 
 
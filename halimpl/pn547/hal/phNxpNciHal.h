@@ -33,6 +33,65 @@ typedef struct nci_data
     uint8_t p_data[NCI_MAX_DATA_LEN];
 } nci_data_t;
 
+/* Number of NCI data packets that can be queued for writing; power of two */
+#ifndef NXP_NCIHAL_TX_QUEUE_DEPTH
+#define NXP_NCIHAL_TX_QUEUE_DEPTH   8
+#endif
+
+/* NCI data packet waiting in the write queue */
+typedef struct phNxpNciHal_TxSlot
+{
+    uint16_t len;
+    uint8_t  retry_cnt;
+    uint8_t  p_data[NCI_MAX_DATA_LEN];
+} phNxpNciHal_TxSlot_t;
+
+/* Write queue between phNxpNciHal_write and the TML writer thread */
+typedef struct phNxpNciHal_TxQueue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;        /* signalled when a slot is released */
+    uint8_t  head;
+    uint8_t  count;
+    bool_t   busy;               /* head slot handed to TML */
+    uint32_t full_waits;         /* writers that had to wait for a free slot */
+    phNxpNciHal_TxSlot_t slots[NXP_NCIHAL_TX_QUEUE_DEPTH];
+} phNxpNciHal_TxQueue_t;
+
+/* Room for all proprietary commands sent from phNxpNciHal_core_initialized */
+#ifndef NXP_NCIHAL_INIT_PLAN_SIZE
+#define NXP_NCIHAL_INIT_PLAN_SIZE   4096
+#endif
+#define NXP_NCIHAL_INIT_PLAN_CMDS   16
+
+/* Core initialization stages, sent in this order */
+typedef enum
+{
+    INIT_STAGE_PROP_EXTN = 0,    /* before clock and factory reset handling */
+    INIT_STAGE_PROFILE,
+    INIT_STAGE_RF_CONF,          /* only when FW or settings have changed */
+    INIT_STAGE_CORE_CONF,
+    INIT_STAGE_SWP_PWR           /* after P2P listen mode routing */
+} phNxpNciHal_InitStage_t;
+
+/* One command of the core initialization plan */
+typedef struct phNxpNciHal_InitCmd
+{
+    uint16_t offset;             /* into phNxpNciHal_InitPlan_t.buf */
+    uint16_t len;
+    uint8_t  stage;
+    const char *p_err;           /* logged if the command fails */
+} phNxpNciHal_InitCmd_t;
+
+/* Proprietary settings parsed from the config file into a command list */
+typedef struct phNxpNciHal_InitPlan
+{
+    uint16_t used;
+    uint8_t  count;
+    phNxpNciHal_InitCmd_t cmds[NXP_NCIHAL_INIT_PLAN_CMDS];
+    uint8_t  buf[NXP_NCIHAL_INIT_PLAN_SIZE];
+} phNxpNciHal_InitPlan_t;
+
 typedef enum
 {
    HAL_STATUS_OPEN = 0,
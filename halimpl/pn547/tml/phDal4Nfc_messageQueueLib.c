@@ -22,25 +22,100 @@
 #include <phNxpLog.h>
 #include <linux/ipc.h>
 #include <semaphore.h>
+#include <sched.h>
 #include <errno.h>
 #include <phDal4Nfc_messageQueueLib.h>
+#include <phNxpConfig.h>
 
 
+#if (PH_DAL4NFC_MSG_QUEUE_DEPTH & (PH_DAL4NFC_MSG_QUEUE_DEPTH - 1))
+#error "PH_DAL4NFC_MSG_QUEUE_DEPTH must be a power of two"
+#endif
+
+/*
+ * Each slot carries a sequence number: it equals the enqueue position when the
+ * slot is free for that position and position + 1 once the message is published.
+ * Producers (TML reader/writer, timers, HAL API callers) claim positions with a
+ * CAS on nTail; the single client thread consumes from nHead without locking.
+ *
+ * The ring is allocated once by phDal4Nfc_msgget and never grows: a post to a
+ * full ring is rejected and counted, and the caller decides whether to retry.
+ */
 typedef struct phDal4Nfc_message_queue_item
 {
+    volatile uint32_t nSeq;
     phLibNfc_Message_t nMsg;
-    struct phDal4Nfc_message_queue_item * pPrev;
-    struct phDal4Nfc_message_queue_item * pNext;
 } phDal4Nfc_message_queue_item_t;
 
 typedef struct phDal4Nfc_message_queue
 {
     phDal4Nfc_message_queue_item_t * pItems;
-    pthread_mutex_t nCriticalSectionMutex;
+    uint32_t nDepth;                     /* slots in pItems, a power of two */
+    volatile uint32_t nTail;
+    uint32_t nHead;
+    volatile uint32_t nOverflows;        /* posts rejected because the ring was full */
     sem_t nProcessSemaphore;
 
 } phDal4Nfc_message_queue_t;
 
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgdepth
+**
+** Description      Gets the ring depth from NXP_MSG_QUEUE_DEPTH, rounded up to
+**                  a power of two, or PH_DAL4NFC_MSG_QUEUE_DEPTH if not set
+**
+** Parameters       None
+**
+** Returns          number of slots of the ring
+**
+*******************************************************************************/
+static uint32_t phDal4Nfc_msgdepth(void)
+{
+    unsigned long num = 0;
+    uint32_t nDepth = PH_DAL4NFC_MSG_QUEUE_MIN_DEPTH;
+
+    if (!GetNxpNumValue(NAME_NXP_MSG_QUEUE_DEPTH, &num, sizeof(num)))
+        return PH_DAL4NFC_MSG_QUEUE_DEPTH;
+
+    if (num > PH_DAL4NFC_MSG_QUEUE_MAX_DEPTH)
+    {
+        NXPLOG_TML_W("NXP_MSG_QUEUE_DEPTH %lu too large, using %u", num, PH_DAL4NFC_MSG_QUEUE_MAX_DEPTH);
+        num = PH_DAL4NFC_MSG_QUEUE_MAX_DEPTH;
+    }
+    while (nDepth < num)
+    {
+        nDepth <<= 1;
+    }
+
+    return nDepth;
+}
+
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgdestroy
+**
+** Description      Frees a message queue no thread uses any more
+**
+** Parameters       pQueue - message queue
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phDal4Nfc_msgdestroy(phDal4Nfc_message_queue_t * pQueue)
+{
+    if (sem_destroy(&pQueue->nProcessSemaphore))
+    {
+        NXPLOG_TML_E("Failed to destroy semaphore (errno=0x%08x)", errno);
+    }
+    if (pQueue->nOverflows)
+    {
+        NXPLOG_TML_W("Message queue of depth %u rejected %u messages", pQueue->nDepth, pQueue->nOverflows);
+    }
+    free(pQueue->pItems);
+    free(pQueue);
+}
+
 /*******************************************************************************
 **
 ** Function         phDal4Nfc_msgget
@@ -50,24 +125,33 @@ typedef struct phDal4Nfc_message_queue
 ** Parameters       Ignored, included only for Linux queue API compatibility
 **
 ** Returns          (int) value of pQueue if successful
-**                  -1, if failed to allocate memory or to init mutex
+**                  -1, if failed to allocate memory or to init semaphore
 **
 *******************************************************************************/
 int phDal4Nfc_msgget(key_t key, int msgflg)
 {
     phDal4Nfc_message_queue_t * pQueue;
 
+    uint32_t i;
+
     pQueue = (phDal4Nfc_message_queue_t *) malloc(sizeof(phDal4Nfc_message_queue_t));
     if (pQueue == NULL)
         return -1;
     memset(pQueue, 0, sizeof(phDal4Nfc_message_queue_t));
-    if (pthread_mutex_init(&pQueue->nCriticalSectionMutex, NULL) == -1)
+    pQueue->nDepth = phDal4Nfc_msgdepth();
+    pQueue->pItems = (phDal4Nfc_message_queue_item_t *) malloc(pQueue->nDepth * sizeof(phDal4Nfc_message_queue_item_t));
+    if (pQueue->pItems == NULL)
     {
         free(pQueue);
         return -1;
     }
+    for (i = 0; i < pQueue->nDepth; i++)
+    {
+        pQueue->pItems[i].nSeq = i;
+    }
     if (sem_init(&pQueue->nProcessSemaphore, 0, 0) == -1)
     {
+        free(pQueue->pItems);
         free(pQueue);
         return -1;
     }
@@ -94,13 +178,7 @@ void phDal4Nfc_msgrelease(int msqid)
     {
         sem_post(&pQueue->nProcessSemaphore);
         usleep(300000);
-        if (sem_destroy(&pQueue->nProcessSemaphore))
-        {
-            NXPLOG_TML_E("Failed to destroy semaphore (errno=0x%08x)", errno);
-        }
-        pthread_mutex_destroy (&pQueue->nCriticalSectionMutex);
-
-        free(pQueue);
+        phDal4Nfc_msgdestroy(pQueue);
     }
 
     return;
@@ -121,33 +199,10 @@ void phDal4Nfc_msgrelease(int msqid)
 *******************************************************************************/
 int phDal4Nfc_msgctl(int msqid, int cmd, void *buf)
 {
-    phDal4Nfc_message_queue_t * pQueue;
-    phDal4Nfc_message_queue_item_t * p;
-
     if (msqid == 0)
         return -1;
 
-    pQueue = (phDal4Nfc_message_queue_t *) msqid;
-    pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
-    if (pQueue->pItems != NULL)
-    {
-        p = pQueue->pItems;
-        while (p->pNext != NULL)
-        {
-            p = p->pNext;
-        }
-        while (p->pPrev != NULL)
-        {
-            p = p->pPrev;
-            free(p->pNext);
-            p->pNext = NULL;
-        }
-        free(p);
-    }
-    pQueue->pItems = NULL;
-    pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
-    pthread_mutex_destroy(&pQueue->nCriticalSectionMutex);
-    free(pQueue);
+    phDal4Nfc_msgrelease(msqid);
 
     return 0;
 }
@@ -165,42 +220,52 @@ int phDal4Nfc_msgctl(int msqid, int cmd, void *buf)
 **                  msgflg - ignored
 **
 ** Returns          0,  if successful
-**                  -1, if invalid parameter passed or failed to allocate memory
+**                  -1, if invalid parameter passed or the queue is full
 **
 *******************************************************************************/
 int phDal4Nfc_msgsnd(int msqid, phLibNfc_Message_t * msg, int msgflg)
 {
     phDal4Nfc_message_queue_t * pQueue;
     phDal4Nfc_message_queue_item_t * p;
-    phDal4Nfc_message_queue_item_t * pNew;
+    uint32_t nPos;
+    int32_t nDiff;
 
     if ((msqid == 0) || (msg == NULL) )
         return -1;
 
-
     pQueue = (phDal4Nfc_message_queue_t *) msqid;
-    pNew = (phDal4Nfc_message_queue_item_t *) malloc(sizeof(phDal4Nfc_message_queue_item_t));
-    if (pNew == NULL)
-        return -1;
-    memset(pNew, 0, sizeof(phDal4Nfc_message_queue_item_t));
-    memcpy(&pNew->nMsg, msg, sizeof(phLibNfc_Message_t));
-    pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
 
-    if (pQueue->pItems != NULL)
+    nPos = pQueue->nTail;
+    for (;;)
     {
-        p = pQueue->pItems;
-        while (p->pNext != NULL)
+        p = &pQueue->pItems[nPos & (pQueue->nDepth - 1)];
+        nDiff = (int32_t) (p->nSeq - nPos);
+        if (nDiff == 0)
         {
-            p = p->pNext;
+            /* Slot is free for this position; try to claim it */
+            if (__sync_bool_compare_and_swap(&pQueue->nTail, nPos, nPos + 1))
+                break;
+            nPos = pQueue->nTail;
+        }
+        else if (nDiff < 0)
+        {
+            /* Consumer has not yet released this slot: queue is full */
+            if (__sync_fetch_and_add(&pQueue->nOverflows, 1) == 0)
+            {
+                NXPLOG_TML_W("Message queue full, rejecting message type 0x%x", msg->eMsgType);
+            }
+            return -1;
+        }
+        else
+        {
+            /* Another producer claimed this position first */
+            nPos = pQueue->nTail;
         }
-        p->pNext = pNew;
-        pNew->pPrev = p;
-    }
-    else
-    {
-        pQueue->pItems = pNew;
     }
-    pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
+
+    memcpy(&p->nMsg, msg, sizeof(phLibNfc_Message_t));
+    __sync_synchronize();
+    p->nSeq = nPos + 1;
 
     sem_post(&pQueue->nProcessSemaphore);
 
@@ -212,7 +277,7 @@ int phDal4Nfc_msgsnd(int msqid, phLibNfc_Message_t * msg, int msgflg)
 ** Function         phDal4Nfc_msgrcv
 **
 ** Description      Gets the oldest message from the queue.
-**                  If the queue is empty the function waits (blocks on a mutex)
+**                  If the queue is empty the function waits (blocks on a semaphore)
 **                  until a message is posted to the queue with phDal4Nfc_msgsnd.
 **
 ** Parameters       msqid  - message queue handle
@@ -237,16 +302,42 @@ int phDal4Nfc_msgrcv(int msqid, phLibNfc_Message_t * msg, long msgtyp, int msgfl
 
     sem_wait(&pQueue->nProcessSemaphore);
 
-    pthread_mutex_lock(&pQueue->nCriticalSectionMutex);
-
-    if (pQueue->pItems != NULL)
+    /* Only the client thread receives, so the head needs no protection */
+    p = &pQueue->pItems[pQueue->nHead & (pQueue->nDepth - 1)];
+    while (p->nSeq != pQueue->nHead + 1)
     {
-        memcpy(msg, &(pQueue->pItems)->nMsg, sizeof(phLibNfc_Message_t));
-        p = pQueue->pItems->pNext;
-        free(pQueue->pItems);
-        pQueue->pItems = p;
+        /* Woken up by phDal4Nfc_msgrelease with nothing queued */
+        if (pQueue->nTail == pQueue->nHead)
+            return 0;
+        /* Slot claimed by a producer that has not finished copying into it */
+        sched_yield();
     }
-    pthread_mutex_unlock(&pQueue->nCriticalSectionMutex);
+    __sync_synchronize();
+    memcpy(msg, &p->nMsg, sizeof(phLibNfc_Message_t));
+    __sync_synchronize();
+    p->nSeq = pQueue->nHead + pQueue->nDepth;
+    pQueue->nHead++;
 
     return 0;
 }
+
+/*******************************************************************************
+**
+** Function         phDal4Nfc_msgoverflows
+**
+** Description      Gets the number of messages rejected because the ring was full
+**
+** Parameters       msqid  - message queue handle
+**
+** Returns          number of rejected messages, 0 if invalid handle is passed
+**
+*******************************************************************************/
+uint32_t phDal4Nfc_msgoverflows(int msqid)
+{
+    phDal4Nfc_message_queue_t * pQueue = (phDal4Nfc_message_queue_t *) msqid;
+
+    if (pQueue == NULL)
+        return 0;
+
+    return pQueue->nOverflows;
+}
@@ -24,10 +24,23 @@
 #include <linux/ipc.h>
 #include <phNfcTypes.h>
 
+/* Number of messages the ring holds when NXP_MSG_QUEUE_DEPTH is not set; must be a power of two */
+#ifndef PH_DAL4NFC_MSG_QUEUE_DEPTH
+#define PH_DAL4NFC_MSG_QUEUE_DEPTH  64
+#endif
+/* Limits of NXP_MSG_QUEUE_DEPTH */
+#define PH_DAL4NFC_MSG_QUEUE_MIN_DEPTH  8
+#define PH_DAL4NFC_MSG_QUEUE_MAX_DEPTH  1024
+
+/* Retries of a post rejected by a full queue, delay in us */
+#define PH_DAL4NFC_MSG_POST_RETRY_CNT       10
+#define PH_DAL4NFC_MSG_POST_RETRY_DELAY     1000
+
 int phDal4Nfc_msgget(key_t key, int msgflg);
 void phDal4Nfc_msgrelease(int msqid);
 int phDal4Nfc_msgctl(int msqid, int cmd, void *buf);
 int phDal4Nfc_msgsnd(int msqid, phLibNfc_Message_t * msg, int msgflg);
 int phDal4Nfc_msgrcv(int msqid, phLibNfc_Message_t * msg, long msgtyp, int msgflg);
+uint32_t phDal4Nfc_msgoverflows(int msqid);
 
 #endif /*  PHDAL4NFC_MESSAGEQUEUE_H  */
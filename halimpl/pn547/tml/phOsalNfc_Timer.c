@@ -19,6 +19,12 @@
  */
 
 #include <signal.h>
+#ifdef NXP_TIMER_THREAD
+#include <pthread.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#endif
 #include <phNfcTypes.h>
 #include <phOsalNfc_Timer.h>
 #include <phNfcCommon.h>
@@ -46,10 +52,36 @@ extern phNxpNciHal_Control_t nxpncihal_ctrl;
  * Invalid timer ID type. This ID used indicate timer creation is failed */
 #define PH_NFC_TIMER_ID_INVALID                     (0xFFFF)
 
+#ifdef NXP_TIMER_THREAD
+/*
+ * All timers are served by one thread blocked on a CLOCK_MONOTONIC timerfd,
+ * which is always armed for the earliest deadline of a min-heap of running
+ * timers. Expiry posts straight into the client queue.
+ */
+static pthread_mutex_t timerMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t timerThread;
+static int nTimerFd = -1;
+static volatile uint8_t bTimerThreadExit = FALSE;
+static uint64_t aTimerDeadline[PH_NFC_MAX_TIMER];      /* ns, CLOCK_MONOTONIC */
+static uint8_t aTimerHeap[PH_NFC_MAX_TIMER];           /* timer indexes, earliest first */
+static uint8_t aTimerHeapPos[PH_NFC_MAX_TIMER];        /* position + 1 in heap, 0 if not queued */
+static uint32_t dwTimerHeapCount = 0;
+#endif
+
 /* Forward declarations */
 static void phOsalNfc_PostTimerMsg(phLibNfc_Message_t *pMsg);
 static void phOsalNfc_DeferredCall (void *pParams);
+static void phOsalNfc_Timer_Notify(uint32_t dwIndex);
+#ifdef NXP_TIMER_THREAD
+static NFCSTATUS phOsalNfc_TimerThread_Start(void);
+static void phOsalNfc_TimerThread_Stop(void);
+static void *phOsalNfc_TimerThread(void *pParam);
+static void phOsalNfc_TimerHeap_Insert(uint32_t dwIndex);
+static void phOsalNfc_TimerHeap_Remove(uint32_t dwIndex);
+static void phOsalNfc_TimerHeap_Arm(void);
+#else
 static void phOsalNfc_Timer_Expired(union sigval sv);
+#endif
 
 /*
  *************************** Function Definitions ******************************
@@ -72,13 +104,23 @@ uint32_t phOsalNfc_Timer_Create(void)
 {
     /* dwTimerId is also used as an index at which timer object can be stored */
     uint32_t dwTimerId = PH_OSALNFC_TIMER_ID_INVALID;
+#ifndef NXP_TIMER_THREAD
     static struct sigevent se;
+#endif
     phOsalNfc_TimerHandle_t *pTimerHandle;
     /* Timer needs to be initialized for timer usage */
 
+#ifdef NXP_TIMER_THREAD
+        /* The timer thread is started with the first timer */
+        if (NFCSTATUS_SUCCESS != phOsalNfc_TimerThread_Start())
+        {
+            return PH_NFC_TIMER_ID_INVALID;
+        }
+#else
         se.sigev_notify = SIGEV_THREAD;
         se.sigev_notify_function = phOsalNfc_Timer_Expired;
         se.sigev_notify_attributes = NULL;
+#endif
         dwTimerId = phUtilNfc_CheckForAvailableTimer();
 
         /* Check whether timers are available, if yes create a timer handle structure */
@@ -87,6 +129,9 @@ uint32_t phOsalNfc_Timer_Create(void)
             pTimerHandle = (phOsalNfc_TimerHandle_t *)&apTimerInfo[dwTimerId-1];
             /* Build the Timer Id to be returned to Caller Function */
             dwTimerId += PH_NFC_TIMER_BASE_ADDRESS;
+#ifdef NXP_TIMER_THREAD
+            /* Nothing to create, the timer only lives in the heap while running */
+#else
             se.sigev_value.sival_int = (int)dwTimerId;
             /* Create POSIX timer */
             if(timer_create(CLOCK_REALTIME, &se, &(pTimerHandle->hTimerHandle)) == -1)
@@ -94,6 +139,7 @@ uint32_t phOsalNfc_Timer_Create(void)
                 dwTimerId = PH_NFC_TIMER_ID_INVALID;
             }
             else
+#endif
             {
                 /* Set the state to indicate timer is ready */
                 pTimerHandle->eState = eTimerIdle;
@@ -135,7 +181,11 @@ NFCSTATUS phOsalNfc_Timer_Start(uint32_t dwTimerId, uint32_t dwRegTimeCnt, pphOs
 {
     NFCSTATUS wStartStatus= NFCSTATUS_SUCCESS;
 
+#ifdef NXP_TIMER_THREAD
+    struct timespec now;
+#else
     struct itimerspec its;
+#endif
     uint32_t dwIndex;
     phOsalNfc_TimerHandle_t *pTimerHandle;
     /* Retrieve the index at which the timer handle structure is stored */
@@ -146,6 +196,24 @@ NFCSTATUS phOsalNfc_Timer_Start(uint32_t dwTimerId, uint32_t dwRegTimeCnt, pphOs
         if( (dwIndex < PH_NFC_MAX_TIMER) && (0x00 != pTimerHandle->TimerId) &&
                 (NULL != pApplication_callback) )
         {
+#ifdef NXP_TIMER_THREAD
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            pthread_mutex_lock(&timerMutex);
+            /* A running timer is restarted with the new timeout */
+            phOsalNfc_TimerHeap_Remove(dwIndex);
+            aTimerDeadline[dwIndex] = ((uint64_t) now.tv_sec * 1000000000ULL) + now.tv_nsec +
+                    ((uint64_t) dwRegTimeCnt * 1000000ULL);
+            pTimerHandle->Application_callback = pApplication_callback;
+            pTimerHandle->pContext = pContext;
+            pTimerHandle->eState = eTimerRunning;
+            phOsalNfc_TimerHeap_Insert(dwIndex);
+            if (aTimerHeap[0] == dwIndex)
+            {
+                /* New earliest deadline */
+                phOsalNfc_TimerHeap_Arm();
+            }
+            pthread_mutex_unlock(&timerMutex);
+#else
             its.it_interval.tv_sec  = 0;
             its.it_interval.tv_nsec = 0;
             its.it_value.tv_sec     = dwRegTimeCnt / 1000;
@@ -163,6 +231,7 @@ NFCSTATUS phOsalNfc_Timer_Start(uint32_t dwTimerId, uint32_t dwRegTimeCnt, pphOs
             {
                 wStartStatus = PHNFCSTVAL(CID_NFC_OSAL, PH_OSALNFC_TIMER_START_ERROR);
             }
+#endif
         }
         else
         {
@@ -192,7 +261,9 @@ NFCSTATUS phOsalNfc_Timer_Start(uint32_t dwTimerId, uint32_t dwRegTimeCnt, pphOs
 NFCSTATUS phOsalNfc_Timer_Stop(uint32_t dwTimerId)
 {
     NFCSTATUS wStopStatus=NFCSTATUS_SUCCESS;
+#ifndef NXP_TIMER_THREAD
     static struct itimerspec its = {{0, 0}, {0, 0}};
+#endif
 
     uint32_t dwIndex;
     phOsalNfc_TimerHandle_t *pTimerHandle;
@@ -206,6 +277,17 @@ NFCSTATUS phOsalNfc_Timer_Stop(uint32_t dwTimerId)
             /* Stop the timer only if the callback has not been invoked */
             if(pTimerHandle->eState == eTimerRunning)
             {
+#ifdef NXP_TIMER_THREAD
+                pthread_mutex_lock(&timerMutex);
+                /* The timer thread may have expired it meanwhile */
+                if (pTimerHandle->eState == eTimerRunning)
+                {
+                    phOsalNfc_TimerHeap_Remove(dwIndex);
+                    /* Change the state of timer to Stopped */
+                    pTimerHandle->eState = eTimerStopped;
+                }
+                pthread_mutex_unlock(&timerMutex);
+#else
                 if((timer_settime(pTimerHandle->hTimerHandle, 0, &its, NULL)) == -1)
                 {
                     wStopStatus = PHNFCSTVAL(CID_NFC_OSAL, PH_OSALNFC_TIMER_STOP_ERROR);
@@ -215,6 +297,7 @@ NFCSTATUS phOsalNfc_Timer_Stop(uint32_t dwTimerId)
                     /* Change the state of timer to Stopped */
                     pTimerHandle->eState = eTimerStopped;
                 }
+#endif
             }
         }
         else
@@ -258,12 +341,20 @@ NFCSTATUS phOsalNfc_Timer_Delete(uint32_t dwTimerId)
         )
         {
             /* Cancel the timer before deleting */
+#ifdef NXP_TIMER_THREAD
+            pthread_mutex_lock(&timerMutex);
+            phOsalNfc_TimerHeap_Remove(dwIndex);
+            /* Clear Timer structure used to store timer related data */
+            memset(pTimerHandle,(uint8_t)0x00,sizeof(phOsalNfc_TimerHandle_t));
+            pthread_mutex_unlock(&timerMutex);
+#else
             if(timer_delete(pTimerHandle->hTimerHandle) == -1)
             {
                 wDeleteStatus = PHNFCSTVAL(CID_NFC_OSAL, PH_OSALNFC_TIMER_DELETE_ERROR);
             }
             /* Clear Timer structure used to store timer related data */
             memset(pTimerHandle,(uint8_t)0x00,sizeof(phOsalNfc_TimerHandle_t));
+#endif
         }
         else
         {
@@ -301,15 +392,28 @@ void phOsalNfc_Timer_Cleanup(void)
         )
         {
             /* Cancel the timer before deleting */
+#ifdef NXP_TIMER_THREAD
+            pthread_mutex_lock(&timerMutex);
+            phOsalNfc_TimerHeap_Remove(dwIndex);
+            /* Clear Timer structure used to store timer related data */
+            memset(pTimerHandle,(uint8_t)0x00,sizeof(phOsalNfc_TimerHandle_t));
+            pthread_mutex_unlock(&timerMutex);
+#else
             if(timer_delete(pTimerHandle->hTimerHandle) == -1)
             {
                 NXPLOG_TML_E("timer %d delete error!", dwIndex);
             }
             /* Clear Timer structure used to store timer related data */
             memset(pTimerHandle,(uint8_t)0x00,sizeof(phOsalNfc_TimerHandle_t));
+#endif
         }
     }
 
+#ifdef NXP_TIMER_THREAD
+    /* No timers left to serve */
+    phOsalNfc_TimerThread_Stop();
+#endif
+
     return;
 }
 
@@ -360,37 +464,46 @@ static void phOsalNfc_DeferredCall (void *pParams)
 *******************************************************************************/
 static void phOsalNfc_PostTimerMsg(phLibNfc_Message_t *pMsg)
 {
+    uint8_t bRetry = 0;
 
-    (void)phDal4Nfc_msgsnd((uint32_t) nxpncihal_ctrl.gDrvCfg.nClientId/*gpphOsalNfc_Context->dwCallbackThreadID*/, pMsg,0);
+    /* Only fails while the queue is full; a lost expiry would stall the HAL */
+    while (phDal4Nfc_msgsnd((uint32_t) nxpncihal_ctrl.gDrvCfg.nClientId/*gpphOsalNfc_Context->dwCallbackThreadID*/, pMsg,0) != 0)
+    {
+        if (bRetry++ >= PH_DAL4NFC_MSG_POST_RETRY_CNT)
+        {
+            NXPLOG_TML_E("Failed to post timer message to client thread");
+            break;
+        }
+        usleep(PH_DAL4NFC_MSG_POST_RETRY_DELAY);
+    }
 
     return;
 }
 
 /*******************************************************************************
 **
-** Function         phOsalNfc_Timer_Expired
+** Function         phOsalNfc_Timer_Notify
 **
 ** Description      posts message upon expiration of timer
-**                  Shall be invoked when any one timer is expired
 **                  Shall post message on user thread to invoke respective
 **                  callback function provided by the caller of Timer function
 **
+** Parameters       dwIndex - index of the expired timer
+**
 ** Returns          None
 **
 *******************************************************************************/
-static void phOsalNfc_Timer_Expired(union sigval sv)
+static void phOsalNfc_Timer_Notify(uint32_t dwIndex)
 {
-   uint32_t dwIndex;
-   phOsalNfc_TimerHandle_t *pTimerHandle;
-
+    phOsalNfc_TimerHandle_t *pTimerHandle;
+    uint32_t dwTimerId = dwIndex + PH_NFC_TIMER_BASE_ADDRESS + 0x01;
 
-    dwIndex = ((uint32_t)(sv.sival_int)) - PH_NFC_TIMER_BASE_ADDRESS - 0x01;
     pTimerHandle = (phOsalNfc_TimerHandle_t *)&apTimerInfo[dwIndex];
     /* Timer is stopped when callback function is invoked */
     pTimerHandle->eState = eTimerStopped;
 
     pTimerHandle->tDeferedCallInfo.pDeferedCall = &phOsalNfc_DeferredCall;
-    pTimerHandle->tDeferedCallInfo.pParam = (void *) (sv.sival_int);
+    pTimerHandle->tDeferedCallInfo.pParam = (void *) dwTimerId;
 
     pTimerHandle->tOsalMessage.eMsgType = PH_LIBNFC_DEFERREDCALL_MSG;
     pTimerHandle->tOsalMessage.pMsgData = (void *)&pTimerHandle->tDeferedCallInfo;
@@ -402,6 +515,291 @@ static void phOsalNfc_Timer_Expired(union sigval sv)
     return;
 }
 
+#ifndef NXP_TIMER_THREAD
+/*******************************************************************************
+**
+** Function         phOsalNfc_Timer_Expired
+**
+** Description      posts message upon expiration of timer
+**                  Shall be invoked when any one timer is expired
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_Timer_Expired(union sigval sv)
+{
+    phOsalNfc_Timer_Notify(((uint32_t)(sv.sival_int)) - PH_NFC_TIMER_BASE_ADDRESS - 0x01);
+
+    return;
+}
+#else
+/*******************************************************************************
+**
+** Function         phOsalNfc_TimerThread_Start
+**
+** Description      Creates the timerfd and starts the timer thread, unless
+**                  it is already running
+**
+** Returns          NFCSTATUS_SUCCESS if the timer thread is running
+**                  NFCSTATUS_FAILED otherwise
+**
+*******************************************************************************/
+static NFCSTATUS phOsalNfc_TimerThread_Start(void)
+{
+    NFCSTATUS wStatus = NFCSTATUS_SUCCESS;
+
+    pthread_mutex_lock(&timerMutex);
+    if (nTimerFd < 0)
+    {
+        nTimerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (nTimerFd < 0)
+        {
+            NXPLOG_TML_E("timerfd_create() errno : %x", errno);
+            wStatus = NFCSTATUS_FAILED;
+        }
+        else
+        {
+            bTimerThreadExit = FALSE;
+            dwTimerHeapCount = 0;
+            memset(aTimerHeapPos, 0x00, sizeof(aTimerHeapPos));
+            if (pthread_create(&timerThread, NULL, phOsalNfc_TimerThread, NULL) != 0)
+            {
+                NXPLOG_TML_E("timer thread create failed");
+                close(nTimerFd);
+                nTimerFd = -1;
+                wStatus = NFCSTATUS_FAILED;
+            }
+        }
+    }
+    pthread_mutex_unlock(&timerMutex);
+
+    return wStatus;
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_TimerThread_Stop
+**
+** Description      Stops the timer thread and releases the timerfd
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_TimerThread_Stop(void)
+{
+    struct itimerspec its;
+
+    pthread_mutex_lock(&timerMutex);
+    if (nTimerFd < 0)
+    {
+        pthread_mutex_unlock(&timerMutex);
+        return;
+    }
+    bTimerThreadExit = TRUE;
+    /* Fire right away so the thread sees the exit request */
+    memset(&its, 0x00, sizeof(its));
+    its.it_value.tv_nsec = 1;
+    timerfd_settime(nTimerFd, 0, &its, NULL);
+    pthread_mutex_unlock(&timerMutex);
+
+    if (pthread_join(timerThread, NULL) != 0)
+    {
+        NXPLOG_TML_E("Fail to kill timer thread!");
+    }
+
+    pthread_mutex_lock(&timerMutex);
+    close(nTimerFd);
+    nTimerFd = -1;
+    pthread_mutex_unlock(&timerMutex);
+
+    return;
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_TimerThread
+**
+** Description      Waits for the earliest deadline and posts a message for
+**                  every timer that has expired
+**
+** Returns          None
+**
+*******************************************************************************/
+static void *phOsalNfc_TimerThread(void *pParam)
+{
+    uint64_t dwExpirations;
+    uint64_t dwNow;
+    struct timespec now;
+
+    for (;;)
+    {
+        if ((read(nTimerFd, &dwExpirations, sizeof(dwExpirations)) < 0) && (errno != EINTR))
+        {
+            NXPLOG_TML_E("timer thread read() errno : %x", errno);
+        }
+
+        pthread_mutex_lock(&timerMutex);
+        if (bTimerThreadExit)
+        {
+            pthread_mutex_unlock(&timerMutex);
+            break;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        dwNow = ((uint64_t) now.tv_sec * 1000000000ULL) + now.tv_nsec;
+        while ((dwTimerHeapCount > 0) && (aTimerDeadline[aTimerHeap[0]] <= dwNow))
+        {
+            uint32_t dwIndex = aTimerHeap[0];
+
+            phOsalNfc_TimerHeap_Remove(dwIndex);
+            phOsalNfc_Timer_Notify(dwIndex);
+        }
+        phOsalNfc_TimerHeap_Arm();
+        pthread_mutex_unlock(&timerMutex);
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_TimerHeap_Swap
+**
+** Description      Swaps two heap entries, keeping their positions up to date.
+**                  Called with timerMutex held.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_TimerHeap_Swap(uint32_t dwPosA, uint32_t dwPosB)
+{
+    uint8_t bIndex = aTimerHeap[dwPosA];
+
+    aTimerHeap[dwPosA] = aTimerHeap[dwPosB];
+    aTimerHeap[dwPosB] = bIndex;
+    aTimerHeapPos[aTimerHeap[dwPosA]] = dwPosA + 1;
+    aTimerHeapPos[aTimerHeap[dwPosB]] = dwPosB + 1;
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_TimerHeap_Sift
+**
+** Description      Restores heap order around the given position.
+**                  Called with timerMutex held.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_TimerHeap_Sift(uint32_t dwPos)
+{
+    uint32_t dwChild;
+
+    /* Move up while earlier than the parent */
+    while ((dwPos > 0) &&
+           (aTimerDeadline[aTimerHeap[dwPos]] < aTimerDeadline[aTimerHeap[(dwPos - 1) / 2]]))
+    {
+        phOsalNfc_TimerHeap_Swap(dwPos, (dwPos - 1) / 2);
+        dwPos = (dwPos - 1) / 2;
+    }
+
+    /* Move down while later than the earliest child */
+    for (;;)
+    {
+        dwChild = (2 * dwPos) + 1;
+        if (dwChild >= dwTimerHeapCount)
+        {
+            break;
+        }
+        if (((dwChild + 1) < dwTimerHeapCount) &&
+            (aTimerDeadline[aTimerHeap[dwChild + 1]] < aTimerDeadline[aTimerHeap[dwChild]]))
+        {
+            dwChild++;
+        }
+        if (aTimerDeadline[aTimerHeap[dwPos]] <= aTimerDeadline[aTimerHeap[dwChild]])
+        {
+            break;
+        }
+        phOsalNfc_TimerHeap_Swap(dwPos, dwChild);
+        dwPos = dwChild;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_TimerHeap_Insert
+**
+** Description      Adds a timer to the deadline heap.
+**                  Called with timerMutex held.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_TimerHeap_Insert(uint32_t dwIndex)
+{
+    aTimerHeap[dwTimerHeapCount] = (uint8_t) dwIndex;
+    aTimerHeapPos[dwIndex] = (uint8_t) (dwTimerHeapCount + 1);
+    dwTimerHeapCount++;
+    phOsalNfc_TimerHeap_Sift(dwTimerHeapCount - 1);
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_TimerHeap_Remove
+**
+** Description      Removes a timer from the deadline heap, if it is queued.
+**                  The timerfd is left armed; an early wake up is harmless.
+**                  Called with timerMutex held.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_TimerHeap_Remove(uint32_t dwIndex)
+{
+    uint32_t dwPos;
+
+    if (aTimerHeapPos[dwIndex] == 0)
+    {
+        return;
+    }
+    dwPos = aTimerHeapPos[dwIndex] - 1;
+    aTimerHeapPos[dwIndex] = 0;
+    dwTimerHeapCount--;
+    if (dwPos != dwTimerHeapCount)
+    {
+        aTimerHeap[dwPos] = aTimerHeap[dwTimerHeapCount];
+        aTimerHeapPos[aTimerHeap[dwPos]] = dwPos + 1;
+        phOsalNfc_TimerHeap_Sift(dwPos);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phOsalNfc_TimerHeap_Arm
+**
+** Description      Arms the timerfd for the earliest deadline, or disarms it
+**                  when no timer is running.
+**                  Called with timerMutex held.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phOsalNfc_TimerHeap_Arm(void)
+{
+    struct itimerspec its;
+
+    memset(&its, 0x00, sizeof(its));
+    if (dwTimerHeapCount > 0)
+    {
+        its.it_value.tv_sec = aTimerDeadline[aTimerHeap[0]] / 1000000000ULL;
+        its.it_value.tv_nsec = aTimerDeadline[aTimerHeap[0]] % 1000000000ULL;
+    }
+    if (timerfd_settime(nTimerFd, TFD_TIMER_ABSTIME, &its, NULL) != 0)
+    {
+        NXPLOG_TML_E("timerfd_settime() errno : %x", errno);
+    }
+}
+#endif
 
 /*******************************************************************************
 **
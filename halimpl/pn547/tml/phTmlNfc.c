@@ -327,6 +327,7 @@ static void phTmlNfc_TmlThread(void *pParam)
     NFCSTATUS wStatus = NFCSTATUS_SUCCESS;
     int32_t dwNoBytesWrRd = PH_TMLNFC_RESET_VALUE;
     uint8_t temp[260];
+    uint8_t *pRxBuffer;
     /* Transaction info buffer to be passed to Callback Thread */
     static phTmlNfc_TransactInfo_t tTransactionInfo;
     /* Structure containing Tml callback function and parameters to be invoked
@@ -358,8 +359,16 @@ static void phTmlNfc_TmlThread(void *pParam)
             /* Read the data from the file onto the buffer */
             if (NFCSTATUS_INVALID_DEVICE != (uint32_t)gpphTmlNfc_Context->pDevHandle)
             {
+                /* Read straight into the buffer of the read request when it can hold
+                   any frame, so the frame is not copied again before it is passed up */
+                pRxBuffer = temp;
+                if (gpphTmlNfc_Context->tReadInfo.wLength >= sizeof(temp))
+                {
+                    pRxBuffer = gpphTmlNfc_Context->tReadInfo.pBuffer;
+                }
+
                 NXPLOG_TML_D("PN547 - Invoking I2C Read.....\n");
-                dwNoBytesWrRd = phTmlNfc_i2c_read(gpphTmlNfc_Context->pDevHandle, temp, 260);
+                dwNoBytesWrRd = phTmlNfc_i2c_read(gpphTmlNfc_Context->pDevHandle, pRxBuffer, sizeof(temp));
 
                 if (-1 == dwNoBytesWrRd)
                 {
@@ -368,7 +377,10 @@ static void phTmlNfc_TmlThread(void *pParam)
                 }
                 else
                 {
-                    memcpy(gpphTmlNfc_Context->tReadInfo.pBuffer, temp, dwNoBytesWrRd);
+                    if (pRxBuffer == temp)
+                    {
+                        memcpy(gpphTmlNfc_Context->tReadInfo.pBuffer, temp, dwNoBytesWrRd);
+                    }
 
                     NXPLOG_TML_D("PN547 - I2C Read successful.....\n");
                     /* This has to be reset only after a successful read */
@@ -635,16 +647,12 @@ NFCSTATUS phTmlNfc_Shutdown(void)
     {
         /* Reset thread variable to terminate the thread */
         gpphTmlNfc_Context->bThreadDone = 0;
-        usleep(1000);
-        /* Clear All the resources allocated during initialization */
+        /* Pull the reader out of a pending I2C read and wake both threads up */
+        phTmlNfc_i2c_abort_read();
         sem_post(&gpphTmlNfc_Context->rxSemaphore);
-        usleep(1000);
         sem_post(&gpphTmlNfc_Context->txSemaphore);
-        usleep(1000);
         sem_post(&gpphTmlNfc_Context->postMsgSemaphore);
-        usleep(1000);
         sem_post(&gpphTmlNfc_Context->postMsgSemaphore);
-        usleep(1000);
         if (0 != pthread_join(gpphTmlNfc_Context->readerThread, (void**)NULL))
         {
             NXPLOG_TML_E ("Fail to kill reader thread!");
@@ -949,6 +957,7 @@ NFCSTATUS phTmlNfc_IoCtl(phTmlNfc_ControlCode_t eControlCode)
 void phTmlNfc_DeferredCall(uint32_t dwThreadId, phLibNfc_Message_t *ptWorkerMsg)
 {
     int32_t bPostStatus;
+    uint8_t bRetry = 0;
 
     /* Post message on the user thread to invoke the callback function */
     sem_wait(&gpphTmlNfc_Context->postMsgSemaphore);
@@ -956,7 +965,21 @@ void phTmlNfc_DeferredCall(uint32_t dwThreadId, phLibNfc_Message_t *ptWorkerMsg)
             ptWorkerMsg,
             0
             );
+    /* Only fails while the queue is full; a lost completion would stall the HAL */
+    while ((bPostStatus != 0) && (bRetry++ < PH_DAL4NFC_MSG_POST_RETRY_CNT))
+    {
+        usleep(PH_DAL4NFC_MSG_POST_RETRY_DELAY);
+        bPostStatus = phDal4Nfc_msgsnd(gpphTmlNfc_Context->dwCallbackThreadId,
+                ptWorkerMsg,
+                0
+                );
+    }
     sem_post(&gpphTmlNfc_Context->postMsgSemaphore);
+
+    if (bPostStatus != 0)
+    {
+        NXPLOG_TML_E("Failed to post message type 0x%x to client thread", ptWorkerMsg->eMsgType);
+    }
 }
 
 /*******************************************************************************
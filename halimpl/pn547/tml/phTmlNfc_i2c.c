@@ -26,7 +26,8 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <sys/ioctl.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <errno.h>
 
 #include <phNxpLog.h>
@@ -44,6 +45,34 @@
 
 static bool_t bFwDnldFlag = FALSE;
 
+/* Reader wait set: the device plus an eventfd used to wake the reader when
+   the read must be aborted or the framing changes (normal / FW download) */
+static int nEpollFd = -1;
+static int nWakeFd = -1;
+static volatile uint8_t bReadAborted = FALSE;
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_wake_reader
+**
+** Description      Wakes up the reader blocked in phTmlNfc_i2c_read
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phTmlNfc_i2c_wake_reader(void)
+{
+    if (nWakeFd >= 0)
+    {
+        if (eventfd_write(nWakeFd, 1) != 0)
+        {
+            NXPLOG_TML_E("_i2c_wake_reader() errno : %x", errno);
+        }
+    }
+}
+
 /*******************************************************************************
 **
 ** Function         phTmlNfc_i2c_close
@@ -61,6 +90,16 @@ void phTmlNfc_i2c_close(void *pDevHandle)
     {
         close((int32_t)pDevHandle);
     }
+    if (nEpollFd >= 0)
+    {
+        close(nEpollFd);
+        nEpollFd = -1;
+    }
+    if (nWakeFd >= 0)
+    {
+        close(nWakeFd);
+        nWakeFd = -1;
+    }
 
     return;
 }
@@ -82,6 +121,8 @@ void phTmlNfc_i2c_close(void *pDevHandle)
 NFCSTATUS phTmlNfc_i2c_open_and_configure(pphTmlNfc_Config_t pConfig, void ** pLinkHandle)
 {
     int nHandle;
+    int ret;
+    struct epoll_event tEvent;
 
 
     NXPLOG_TML_D("Opening port=%s\n", pConfig->pDevName);
@@ -94,6 +135,31 @@ NFCSTATUS phTmlNfc_i2c_open_and_configure(pphTmlNfc_Config_t pConfig, void ** pL
         return NFCSTATUS_INVALID_DEVICE;
     }
 
+    /* Wait set for the reader: device data or a wake up from the HAL */
+    nWakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    nEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    bReadAborted = FALSE;
+    ret = -1;
+    if ((nWakeFd >= 0) && (nEpollFd >= 0))
+    {
+        memset(&tEvent, 0, sizeof(tEvent));
+        tEvent.events = EPOLLIN;
+        tEvent.data.fd = nHandle;
+        ret = epoll_ctl(nEpollFd, EPOLL_CTL_ADD, nHandle, &tEvent);
+        if (ret == 0)
+        {
+            tEvent.data.fd = nWakeFd;
+            ret = epoll_ctl(nEpollFd, EPOLL_CTL_ADD, nWakeFd, &tEvent);
+        }
+    }
+    if (ret != 0)
+    {
+        NXPLOG_TML_E("_i2c_open() failed to set up reader wait, errno : %x", errno);
+        phTmlNfc_i2c_close((void*) nHandle);
+        *pLinkHandle = NULL;
+        return NFCSTATUS_INVALID_DEVICE;
+    }
+
     *pLinkHandle = (void*) nHandle;
 
     /*Reset PN547*/
@@ -123,10 +189,11 @@ NFCSTATUS phTmlNfc_i2c_open_and_configure(pphTmlNfc_Config_t pConfig, void ** pL
 int phTmlNfc_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead)
 {
     int ret_Read;
-    int ret_Select;
+    int ret_Wait;
     int numRead = 0;
-    struct timeval tv;
-    fd_set rfds;
+    struct epoll_event tEvents[2];
+    eventfd_t nWakeCount;
+    bool_t bDataReady = FALSE;
     uint16_t totalBtyesToRead = 0;
 
     int i;
@@ -136,6 +203,41 @@ int phTmlNfc_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead)
         return -1;
     }
 
+    /* Block until the device has a frame or the HAL wakes the reader up.
+       A wake up for a mode switch just restarts the wait, so the framing
+       below is always chosen for the current mode. */
+    while (FALSE == bDataReady)
+    {
+        ret_Wait = epoll_wait(nEpollFd, tEvents, 2, -1);
+        if (ret_Wait < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            NXPLOG_TML_E("i2c epoll_wait() errno : %x",errno);
+            return -1;
+        }
+
+        for (i = 0; i < ret_Wait; i++)
+        {
+            if (tEvents[i].data.fd == nWakeFd)
+            {
+                (void) eventfd_read(nWakeFd, &nWakeCount);
+            }
+            else
+            {
+                bDataReady = TRUE;
+            }
+        }
+
+        if (__sync_lock_test_and_set(&bReadAborted, FALSE))
+        {
+            NXPLOG_TML_D("_i2c_read() aborted");
+            return -1;
+        }
+    }
+
     if (FALSE == bFwDnldFlag)
     {
         totalBtyesToRead = NORMAL_MODE_HEADER_LEN;
@@ -145,28 +247,9 @@ int phTmlNfc_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead)
         totalBtyesToRead = FW_DNLD_HEADER_LEN;
     }
 
-    /* Read with 2 second timeout, so that the read thread can be aborted
-       when the pn547 does not respond and we need to switch to FW download
-       mode. This should be done via a control socket instead. */
-    FD_ZERO(&rfds);
-    FD_SET((int) pDevHandle, &rfds);
-    tv.tv_sec = 2;
-    tv.tv_usec = 1;
-
-    ret_Select = select((int)((int)pDevHandle + (int)1), &rfds, NULL, NULL, &tv);
-    if (ret_Select < 0)
-    {
-        NXPLOG_TML_E("i2c select() errno : %x",errno);
-        return -1;
-    }
-    else if (ret_Select == 0)
+    while (numRead < totalBtyesToRead)
     {
-        NXPLOG_TML_E("i2c select() Timeout");
-        return -1;
-    }
-    else
-    {
-        ret_Read = read((int)pDevHandle, pBuffer, totalBtyesToRead - numRead);
+        ret_Read = read((int)pDevHandle, pBuffer + numRead, totalBtyesToRead - numRead);
         if (ret_Read > 0)
         {
             numRead += ret_Read;
@@ -181,37 +264,20 @@ int phTmlNfc_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead)
             NXPLOG_TML_E("_i2c_read() [hdr] errno : %x",errno);
             return -1;
         }
+    }
 
-        if (FALSE == bFwDnldFlag)
-        {
-            totalBtyesToRead = NORMAL_MODE_HEADER_LEN;
-        }
-        else
-        {
-            totalBtyesToRead = FW_DNLD_HEADER_LEN;
-        }
+    if(TRUE == bFwDnldFlag)
+    {
+        totalBtyesToRead = pBuffer[FW_DNLD_LEN_OFFSET] + FW_DNLD_HEADER_LEN + CRC_LEN;
+    }
+    else
+    {
+        totalBtyesToRead = pBuffer[NORMAL_MODE_LEN_OFFSET] + NORMAL_MODE_HEADER_LEN;
+    }
 
-        if(numRead < totalBtyesToRead)
-        {
-            ret_Read = read((int)pDevHandle, pBuffer, totalBtyesToRead - numRead);
-            if (ret_Read != totalBtyesToRead - numRead)
-            {
-                NXPLOG_TML_E("_i2c_read() [hdr] errno : %x",errno);
-                return -1;
-            }
-            else
-            {
-                numRead += ret_Read;
-            }
-        }
-        if(TRUE == bFwDnldFlag)
-        {
-            totalBtyesToRead = pBuffer[FW_DNLD_LEN_OFFSET] + FW_DNLD_HEADER_LEN + CRC_LEN;
-        }
-        else
-        {
-            totalBtyesToRead = pBuffer[NORMAL_MODE_LEN_OFFSET] + NORMAL_MODE_HEADER_LEN;
-        }
+    /* Frames without payload need no second transfer */
+    while (numRead < totalBtyesToRead)
+    {
         ret_Read = read((int)pDevHandle, (pBuffer + numRead), totalBtyesToRead - numRead);
         if (ret_Read > 0)
         {
@@ -225,15 +291,30 @@ int phTmlNfc_i2c_read(void *pDevHandle, uint8_t * pBuffer, int nNbBytesToRead)
         else
         {
             NXPLOG_TML_E("_i2c_read() [pyld] errno : %x",errno);
-            if (errno == EINTR || errno == EAGAIN )
-            {
-                return -1;
-            }
+            return -1;
         }
     }
     return numRead;
 }
 
+/*******************************************************************************
+**
+** Function         phTmlNfc_i2c_abort_read
+**
+** Description      Makes a read blocked in phTmlNfc_i2c_read (or the next one)
+**                  return -1 immediately, e.g. on shutdown
+**
+** Parameters       None
+**
+** Returns          None
+**
+*******************************************************************************/
+void phTmlNfc_i2c_abort_read(void)
+{
+    bReadAborted = TRUE;
+    phTmlNfc_i2c_wake_reader();
+}
+
 /*******************************************************************************
 **
 ** Function         phTmlNfc_i2c_write
@@ -315,6 +396,8 @@ int phTmlNfc_i2c_reset(void *pDevHandle, long level)
     }else{
         bFwDnldFlag = FALSE;
     }
+    /* Let a waiting reader pick up the framing of the new mode */
+    phTmlNfc_i2c_wake_reader();
     return ret;
 }
 
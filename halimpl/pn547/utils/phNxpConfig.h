@@ -39,6 +39,8 @@
 #ifndef __CONFIG_H
 #define __CONFIG_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -48,7 +50,8 @@ int GetNxpStrValue(const char* name, char* p_value, unsigned long len);
 int GetNxpNumValue(const char* name, void* p_value, unsigned long len);
 int GetNxpByteArrayValue(const char* name, char* pValue,long bufflen, long *len);
 void resetNxpConfig(void);
-int isNxpConfigModified();
+int isNxpInitStateModified(uint32_t fw_ver, uint32_t plan_hash);
+void updateNxpInitState(uint32_t fw_ver, uint32_t plan_hash);
 
 #ifdef __cplusplus
 };
@@ -79,6 +82,7 @@ int isNxpConfigModified();
 #define NAME_NXP_CORE_STANDBY        "NXP_CORE_STANDBY"
 #define NAME_NXP_NFC_PROFILE_EXTN    "NXP_NFC_PROFILE_EXTN"
 #define NAME_NXP_SWP_FULL_PWR_ON     "NXP_SWP_FULL_PWR_ON"
+#define NAME_NXP_MSG_QUEUE_DEPTH     "NXP_MSG_QUEUE_DEPTH"
 
 
 /* default configuration */
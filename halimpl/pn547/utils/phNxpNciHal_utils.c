@@ -37,6 +37,19 @@
 #include <phNxpNciHal_utils.h>
 #include <errno.h>
 #include <phNxpLog.h>
+#include <stdio.h>
+#include <cutils/properties.h>
+#include <string.h>
+#include <time.h>
+
+/* Ring of the last NCI packets sent and received, see phNxpNciHal_print_packet */
+static struct
+{
+    pthread_mutex_t lock;
+    uint32_t head;          /* free running offset of the oldest record */
+    uint32_t tail;          /* free running offset of the next record */
+    uint8_t  buf[NXP_NCI_TRACE_SIZE];
+} nci_trace = { PTHREAD_MUTEX_INITIALIZER };
 
 /*********************** Link list functions **********************************/
 
@@ -474,11 +487,86 @@ void phNxpNciHal_releaseall_cb_data(void)
 
 /**************************** Other functions *********************************/
 
+/*******************************************************************************
+**
+** Function         phNxpNciHal_trace_copy_in
+**
+** Description      Copy bytes into the trace ring at a free running position
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phNxpNciHal_trace_copy_in(uint32_t pos, const void *p_src,
+        uint16_t len)
+{
+    uint32_t off = pos & (NXP_NCI_TRACE_SIZE - 1);
+    uint32_t first = NXP_NCI_TRACE_SIZE - off;
+
+    if (first >= len)
+    {
+        memcpy(&nci_trace.buf[off], p_src, len);
+    }
+    else
+    {
+        memcpy(&nci_trace.buf[off], p_src, first);
+        memcpy(nci_trace.buf, (const uint8_t *) p_src + first, len - first);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_trace_copy_out
+**
+** Description      Copy bytes out of the trace ring at a free running position
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phNxpNciHal_trace_copy_out(void *p_dst, uint32_t pos, uint16_t len)
+{
+    uint32_t off = pos & (NXP_NCI_TRACE_SIZE - 1);
+    uint32_t first = NXP_NCI_TRACE_SIZE - off;
+
+    if (first >= len)
+    {
+        memcpy(p_dst, &nci_trace.buf[off], len);
+    }
+    else
+    {
+        memcpy(p_dst, &nci_trace.buf[off], first);
+        memcpy((uint8_t *) p_dst + first, nci_trace.buf, len - first);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_trace_to_hex
+**
+** Description      Format bytes as an upper case hex string
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phNxpNciHal_trace_to_hex(char *p_out, const uint8_t *p_data,
+        uint16_t len)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    uint16_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        *p_out++ = hex[p_data[i] >> 4];
+        *p_out++ = hex[p_data[i] & 0x0F];
+    }
+    *p_out = '\0';
+}
+
 /*******************************************************************************
 **
 ** Function         phNxpNciHal_print_packet
 **
-** Description      Print packet
+** Description      Record packet in the trace ring, and print it if NCIX/NCIR
+**                  debug logs are enabled
 **
 ** Returns          None
 **
@@ -486,25 +574,173 @@ void phNxpNciHal_releaseall_cb_data(void)
 void phNxpNciHal_print_packet(const char *pString, const uint8_t *p_data,
         uint16_t len)
 {
-    uint32_t i, j;
-    char print_buffer[len * 3 + 1];
+    phNxpNciHal_TraceHdr_t hdr;
+    struct timespec now;
+    uint32_t rec_len;
+    uint8_t log_level;
+    char print_buffer[NXP_NCI_TRACE_MAX_LEN * 2 + 1];
 
-    memset (print_buffer, 0, sizeof(print_buffer));
-    for (i = 0; i < len; i++) {
-        snprintf(&print_buffer[i * 2], 3, "%02X", p_data[i]);
-    }
     if( 0 == memcmp(pString,"SEND",0x04))
     {
-        NXPLOG_NCIX_D("len = %3d > %s", len, print_buffer);
+        hdr.dir = NXP_NCI_TRACE_SEND;
+        log_level = gLog_level.ncix_log_level;
     }
     else if( 0 == memcmp(pString,"RECV",0x04))
     {
-        NXPLOG_NCIR_D("len = %3d > %s", len, print_buffer);
+        hdr.dir = NXP_NCI_TRACE_RECV;
+        log_level = gLog_level.ncir_log_level;
+    }
+    else
+    {
+        return;
+    }
+    if (len > NXP_NCI_TRACE_MAX_LEN)
+    {
+        len = NXP_NCI_TRACE_MAX_LEN;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    hdr.timestamp = (uint32_t) (now.tv_sec * 1000 + now.tv_nsec / 1000000);
+    hdr.len = len;
+    hdr.reserved = 0;
+    rec_len = (sizeof(hdr) + len + 3) & ~3;
+
+    pthread_mutex_lock(&nci_trace.lock);
+    /* Drop the oldest records to make room */
+    while (nci_trace.tail + rec_len - nci_trace.head > NXP_NCI_TRACE_SIZE)
+    {
+        phNxpNciHal_TraceHdr_t old;
+
+        phNxpNciHal_trace_copy_out(&old, nci_trace.head, sizeof(old));
+        nci_trace.head += (sizeof(old) + old.len + 3) & ~3;
+    }
+    phNxpNciHal_trace_copy_in(nci_trace.tail, &hdr, sizeof(hdr));
+    phNxpNciHal_trace_copy_in(nci_trace.tail + sizeof(hdr), p_data, len);
+    nci_trace.tail += rec_len;
+    pthread_mutex_unlock(&nci_trace.lock);
+
+    if (log_level >= NXPLOG_LOG_DEBUG_LOGLEVEL)
+    {
+        phNxpNciHal_trace_to_hex(print_buffer, p_data, len);
+        if (hdr.dir == NXP_NCI_TRACE_SEND)
+        {
+            NXPLOG_NCIX_D("len = %3d > %s", len, print_buffer);
+        }
+        else
+        {
+            NXPLOG_NCIR_D("len = %3d > %s", len, print_buffer);
+        }
     }
 
     return;
 }
 
+/*******************************************************************************
+**
+** Function         phNxpNciHal_trace_dump
+**
+** Description      Print all packets held in the trace ring, oldest first
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpNciHal_trace_dump(void)
+{
+    phNxpNciHal_TraceHdr_t hdr;
+    uint32_t pos;
+    uint8_t data[NXP_NCI_TRACE_MAX_LEN];
+    char print_buffer[NXP_NCI_TRACE_MAX_LEN * 2 + 1];
+
+    pthread_mutex_lock(&nci_trace.lock);
+    NXPLOG_NCIHAL_E("NCI trace: %u bytes", nci_trace.tail - nci_trace.head);
+    for (pos = nci_trace.head; pos != nci_trace.tail;
+            pos += (sizeof(hdr) + hdr.len + 3) & ~3)
+    {
+        phNxpNciHal_trace_copy_out(&hdr, pos, sizeof(hdr));
+        phNxpNciHal_trace_copy_out(data, pos + sizeof(hdr), hdr.len);
+        phNxpNciHal_trace_to_hex(print_buffer, data, hdr.len);
+        NXPLOG_NCIHAL_E("%u.%03u %s len = %3d > %s", hdr.timestamp / 1000,
+                hdr.timestamp % 1000,
+                (hdr.dir == NXP_NCI_TRACE_SEND) ? "SEND" : "RECV",
+                hdr.len, print_buffer);
+    }
+    pthread_mutex_unlock(&nci_trace.lock);
+
+    return;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_trace_save
+**
+** Description      Write the raw trace records, oldest first, to a file for
+**                  offline decoding
+**
+** Returns          0 if successful, -1 otherwise
+**
+*******************************************************************************/
+static int phNxpNciHal_trace_save(const char *path)
+{
+    FILE *fd;
+    uint32_t off;
+    uint32_t len;
+    int ret = 0;
+
+    fd = fopen(path, "wb");
+    if (fd == NULL)
+    {
+        NXPLOG_NCIHAL_E("Cannot open %s (errno=0x%08x)", path, errno);
+        return -1;
+    }
+
+    pthread_mutex_lock(&nci_trace.lock);
+    off = nci_trace.head & (NXP_NCI_TRACE_SIZE - 1);
+    len = nci_trace.tail - nci_trace.head;
+    if (off + len > NXP_NCI_TRACE_SIZE)
+    {
+        if (fwrite(&nci_trace.buf[off], 1, NXP_NCI_TRACE_SIZE - off, fd) !=
+                NXP_NCI_TRACE_SIZE - off)
+        {
+            ret = -1;
+        }
+        len -= NXP_NCI_TRACE_SIZE - off;
+        off = 0;
+    }
+    if ((ret == 0) && (fwrite(&nci_trace.buf[off], 1, len, fd) != len))
+    {
+        ret = -1;
+    }
+    pthread_mutex_unlock(&nci_trace.lock);
+
+    fclose(fd);
+    return ret;
+}
+
+/*******************************************************************************
+**
+** Function         phNxpNciHal_trace_recovery
+**
+** Description      Print the trace ring before a recovery and, if the
+**                  nfc.nxp_trace_file property names a file, save it there
+**
+** Returns          None
+**
+*******************************************************************************/
+void phNxpNciHal_trace_recovery(void)
+{
+    char path[PROPERTY_VALUE_MAX];
+
+    phNxpNciHal_trace_dump();
+
+    if (property_get(PROP_NAME_NXP_NCI_TRACE_FILE, path, "") > 0)
+    {
+        if (phNxpNciHal_trace_save(path) == 0)
+        {
+            NXPLOG_NCIHAL_E("NCI trace saved to %s", path);
+        }
+    }
+}
+
 
 /*******************************************************************************
 **
@@ -518,6 +754,7 @@ void phNxpNciHal_print_packet(const char *pString, const uint8_t *p_data,
 
 void phNxpNciHal_emergency_recovery(void)
 {
+    phNxpNciHal_trace_recovery();
     NXPLOG_NCIHAL_E("%s: abort()", __FUNCTION__);
 //    abort();
 }
@@ -90,6 +90,32 @@ typedef struct phNxpNciHal_Monitor
 
 } phNxpNciHal_Monitor_t;
 
+/* Size of the NCI packet trace ring in bytes; power of two */
+#ifndef NXP_NCI_TRACE_SIZE
+#define NXP_NCI_TRACE_SIZE      16384
+#endif
+/* Packets longer than this are truncated in the trace */
+#define NXP_NCI_TRACE_MAX_LEN   300
+
+/* System property naming a file the trace ring is saved to on recovery,
+ * e.g. setprop nfc.nxp_trace_file /data/nfc/nci_trace.bin */
+#define PROP_NAME_NXP_NCI_TRACE_FILE    "nfc.nxp_trace_file"
+
+/* NCI packet trace directions */
+#define NXP_NCI_TRACE_SEND      0x00
+#define NXP_NCI_TRACE_RECV      0x01
+
+/* Trace record header, followed by len raw packet bytes padded to 4 bytes.
+ * phNxpNciHal_trace_recovery saves the records oldest first in this format
+ * to the file named by PROP_NAME_NXP_NCI_TRACE_FILE. */
+typedef struct phNxpNciHal_TraceHdr
+{
+    uint32_t timestamp;     /* ms, CLOCK_MONOTONIC */
+    uint16_t len;
+    uint8_t  dir;
+    uint8_t  reserved;
+} phNxpNciHal_TraceHdr_t;
+
 /************************ Exposed functions ***********************************/
 /* List functions */
 int listInit(struct listHead* pList);
@@ -109,6 +135,8 @@ void phNxpNciHal_cleanup_cb_data(phNxpNciHal_Sem_t* pCallbackData);
 void phNxpNciHal_releaseall_cb_data(void);
 void phNxpNciHal_print_packet(const char *pString, const uint8_t *p_data,
         uint16_t len);
+void phNxpNciHal_trace_dump(void);
+void phNxpNciHal_trace_recovery(void);
 void phNxpNciHal_emergency_recovery(void);
 
 /* Lock unlock helper macros */
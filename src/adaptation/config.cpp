@@ -18,6 +18,12 @@
 #include "OverrideLog.h"
 #include "config.h"
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <string>
 #include <vector>
 #include <list>
@@ -32,6 +38,36 @@ const char transport_config_path[] = "/etc/";
 #define extra_config_ext        ".conf"
 #define     IsStringValue       0x80000000
 
+#ifdef NFC_CONFIG_CACHE
+/* precompiled settings of one config file, written next to the NFA storage */
+#define CONFIG_CACHE_MAGIC      0x4346434EUL    /* "NCFC" */
+#define CONFIG_CACHE_VERSION    2
+
+const char config_cache_path[] = default_storage_location "/";
+#define config_cache_ext        ".bin"
+
+struct CNfcCacheHdr
+{
+    uint32_t    magic;
+    uint32_t    version;
+    uint64_t    src_mtime;      /* of the .conf file the cache was built from */
+    uint64_t    src_ino;
+    uint32_t    src_size;
+    uint32_t    src_hash;       /* FNV-1a of the .conf content */
+    uint32_t    path_len;       /* .conf path follows the header */
+    uint32_t    count;          /* number of records following the path */
+    uint32_t    data_len;       /* total length of the records */
+};
+
+/* followed by name_len bytes of NUL terminated name and str_len value bytes */
+struct CNfcCacheRec
+{
+    uint64_t    num_value;
+    uint32_t    str_len;
+    uint32_t    name_len;
+};
+#endif
+
 using namespace::std;
 
 class CNfcParam : public string
@@ -67,9 +103,26 @@ private:
     void    moveFromList();
     void    moveToList();
     void    add(const CNfcParam* pParam);
+    void    buildIndex();
+    static unsigned long hashName(const char* p_name);
+#ifdef NFC_CONFIG_CACHE
+    bool    readCache(const char* name, const struct stat& st, uint32_t hash);
+    void    writeCache(const char* name, const struct stat& st, uint32_t hash);
+    static string cachePath(const char* name);
+    static uint32_t fileHash(FILE* fd);
+    vector<const CNfcParam*> m_parsed;      /* added by the current readConfig */
+#endif
     list<const CNfcParam*> m_list;
     bool    mValidFile;
 
+    /* open addressed name index over the setting array, rebuilt on load */
+    struct CNfcIndexSlot
+    {
+        unsigned long       hash;
+        const CNfcParam*    param;
+    };
+    vector<CNfcIndexSlot>   m_index;
+
     unsigned long   state;
 
     inline bool Is(unsigned long f) {return (state & f) == f;}
@@ -193,6 +246,21 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
             moveToList();
     }
 
+#ifdef NFC_CONFIG_CACHE
+    struct stat st;
+    bool    bCache = (fstat(fileno(fd), &st) == 0);
+    uint32_t hash = bCache ? fileHash(fd) : 0;
+
+    if (bCache && readCache(name, st, hash))
+    {
+        fclose(fd);
+        m_parsed.clear();
+        moveFromList();
+        return size() > 0;
+    }
+    m_parsed.clear();
+#endif
+
     while (!feof(fd) && fread(&c, 1, 1, fd) == 1)
     {
         switch (state & 0xff)
@@ -332,11 +400,212 @@ bool CNfcConfig::readConfig(const char* name, bool bResetContent)
     }
 
     fclose(fd);
+#ifdef NFC_CONFIG_CACHE
+    if (bCache)
+        writeCache(name, st, hash);
+    m_parsed.clear();
+#endif
 
     moveFromList();
     return size() > 0;
 }
 
+#ifdef NFC_CONFIG_CACHE
+/*******************************************************************************
+**
+** Function:    CNfcConfig::cachePath()
+**
+** Description: name of the precompiled cache of a config file
+**
+** Returns:     cache file path
+**
+*******************************************************************************/
+string CNfcConfig::cachePath(const char* name)
+{
+    const char* p_base = strrchr(name, '/');
+    string path(config_cache_path);
+
+    path += (p_base != NULL) ? p_base + 1 : name;
+    path += config_cache_ext;
+    return path;
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfig::fileHash()
+**
+** Description: FNV-1a hash of a config file's content, so a cache is not used
+**              for a .conf whose content changed without a new size or mtime
+**              (e.g. reproducible /system builds); rewinds the file
+**
+** Returns:     hash of the file content
+**
+*******************************************************************************/
+uint32_t CNfcConfig::fileHash(FILE* fd)
+{
+    unsigned char buf[1024];
+    size_t  len;
+    uint32_t hash = 0x811C9DC5;
+
+    while ((len = fread(buf, 1, sizeof(buf), fd)) > 0)
+    {
+        for (size_t i = 0; i < len; ++i)
+        {
+            hash ^= buf[i];
+            hash *= 0x01000193;
+        }
+    }
+    rewind(fd);
+    return hash;
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfig::readCache()
+**
+** Description: load the settings of a config file from its precompiled cache
+**              into the linked list; the cache is only used when it was built
+**              from the same path, inode, size, modification time and content
+**
+** Returns:     true, if the settings were loaded, false otherwise
+**
+*******************************************************************************/
+bool CNfcConfig::readCache(const char* name, const struct stat& st, uint32_t hash)
+{
+    string      path = cachePath(name);
+    struct stat cst;
+    int         fd = open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        return false;
+    if (fstat(fd, &cst) != 0 || cst.st_size < (off_t)sizeof(CNfcCacheHdr))
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t  len = cst.st_size;
+    void*   p_map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p_map == MAP_FAILED)
+        return false;
+
+    const char* p = (const char*)p_map;
+    const char* p_end = p + len;
+    vector<const CNfcParam*> params;
+    CNfcCacheHdr hdr;
+    bool    valid = false;
+
+    memcpy(&hdr, p, sizeof(hdr));
+    p += sizeof(hdr);
+    if (hdr.magic == CONFIG_CACHE_MAGIC && hdr.version == CONFIG_CACHE_VERSION &&
+        hdr.src_mtime == (uint64_t)st.st_mtime && hdr.src_ino == (uint64_t)st.st_ino &&
+        hdr.src_size == (uint32_t)st.st_size && hdr.src_hash == hash &&
+        hdr.path_len == strlen(name) &&
+        (uint64_t)(p_end - p) == (uint64_t)hdr.path_len + hdr.data_len &&
+        memcmp(p, name, hdr.path_len) == 0)
+    {
+        p += hdr.path_len;
+        valid = true;
+        for (uint32_t n = 0; valid && n < hdr.count; ++n)
+        {
+            CNfcCacheRec rec;
+
+            if ((size_t)(p_end - p) < sizeof(rec))
+            {
+                valid = false;
+                break;
+            }
+            memcpy(&rec, p, sizeof(rec));
+            p += sizeof(rec);
+            if (rec.name_len == 0 || (uint64_t)(p_end - p) < (uint64_t)rec.name_len + rec.str_len ||
+                p[rec.name_len - 1] != '\0')
+            {
+                valid = false;
+                break;
+            }
+            if (rec.str_len > 0)
+                params.push_back(new CNfcParam(p, string(p + rec.name_len, rec.str_len)));
+            else
+                params.push_back(new CNfcParam(p, (unsigned long)rec.num_value));
+            p += rec.name_len + rec.str_len;
+        }
+        valid = valid && (p == p_end);
+    }
+    munmap(p_map, len);
+
+    if (!valid)
+    {
+        ALOGD("%s Ignoring stale config cache %s\n", __func__, path.c_str());
+        for (vector<const CNfcParam*>::iterator it = params.begin(), itEnd = params.end(); it != itEnd; ++it)
+            delete *it;
+        return false;
+    }
+    for (vector<const CNfcParam*>::iterator it = params.begin(), itEnd = params.end(); it != itEnd; ++it)
+        add(*it);
+    ALOGD("%s Loaded %u settings from %s\n", __func__, hdr.count, path.c_str());
+    return true;
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfig::writeCache()
+**
+** Description: save the settings just parsed from a config file into its
+**              precompiled cache; the file is replaced atomically so a reader
+**              never sees a partial cache
+**
+** Returns:     none
+**
+*******************************************************************************/
+void CNfcConfig::writeCache(const char* name, const struct stat& st, uint32_t hash)
+{
+    string  path = cachePath(name);
+    string  tmp = path + ".tmp";
+    string  data;
+    CNfcCacheHdr hdr;
+    FILE*   fd;
+
+    for (vector<const CNfcParam*>::const_iterator it = m_parsed.begin(), itEnd = m_parsed.end(); it != itEnd; ++it)
+    {
+        CNfcCacheRec rec;
+
+        rec.num_value = (*it)->numValue();
+        rec.str_len = (*it)->str_len();
+        rec.name_len = (*it)->length() + 1;
+        data.append((const char*)&rec, sizeof(rec));
+        data.append((*it)->c_str(), rec.name_len);
+        data.append((*it)->str_value(), rec.str_len);
+    }
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = CONFIG_CACHE_MAGIC;
+    hdr.version = CONFIG_CACHE_VERSION;
+    hdr.src_mtime = st.st_mtime;
+    hdr.src_ino = st.st_ino;
+    hdr.src_size = st.st_size;
+    hdr.src_hash = hash;
+    hdr.path_len = strlen(name);
+    hdr.count = m_parsed.size();
+    hdr.data_len = data.size();
+
+    if ((fd = fopen(tmp.c_str(), "wb")) == NULL)
+    {
+        ALOGD("%s Cannot create config cache %s\n", __func__, tmp.c_str());
+        return;
+    }
+    bool ok = fwrite(&hdr, sizeof(hdr), 1, fd) == 1 &&
+              fwrite(name, 1, hdr.path_len, fd) == hdr.path_len &&
+              fwrite(data.data(), 1, data.size(), fd) == data.size();
+    ok = (fclose(fd) == 0) && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+    {
+        ALOGE("%s Cannot write config cache %s\n", __func__, path.c_str());
+        remove(tmp.c_str());
+    }
+}
+#endif
+
 /*******************************************************************************
 **
 ** Function:    CNfcConfig::CNfcConfig()
@@ -485,27 +754,46 @@ bool CNfcConfig::getValue(const char* name, unsigned short& rValue) const
 *******************************************************************************/
 const CNfcParam* CNfcConfig::find(const char* p_name) const
 {
-    if (size() == 0)
+    if (m_index.empty())
         return NULL;
 
-    for (const_iterator it = begin(), itEnd = end(); it != itEnd; ++it)
+    unsigned long hash = hashName(p_name);
+    size_t mask = m_index.size() - 1;
+
+    for (size_t i = hash & mask; m_index[i].param != NULL; i = (i + 1) & mask)
     {
-        if (**it < p_name)
+        if (m_index[i].hash != hash || *m_index[i].param != p_name)
             continue;
-        else if (**it == p_name)
-        {
-            if((*it)->str_len() > 0)
-                ALOGD("%s found %s=%s\n", __func__, p_name, (*it)->str_value());
-            else
-                ALOGD("%s found %s=(0x%lX)\n", __func__, p_name, (*it)->numValue());
-            return *it;
-        }
+        if(m_index[i].param->str_len() > 0)
+            ALOGV("%s found %s=%s\n", __func__, p_name, m_index[i].param->str_value());
         else
-            break;
+            ALOGV("%s found %s=(0x%lX)\n", __func__, p_name, m_index[i].param->numValue());
+        return m_index[i].param;
     }
     return NULL;
 }
 
+/*******************************************************************************
+**
+** Function:    CNfcConfig::hashName()
+**
+** Description: FNV-1a hash of a setting name
+**
+** Returns:     hash value
+**
+*******************************************************************************/
+unsigned long CNfcConfig::hashName(const char* p_name)
+{
+    unsigned long hash = 2166136261UL;
+
+    while (*p_name)
+    {
+        hash ^= (unsigned char)*p_name++;
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
 /*******************************************************************************
 **
 ** Function:    CNfcConfig::clean()
@@ -520,6 +808,7 @@ void CNfcConfig::clean()
     if (size() == 0)
         return;
 
+    m_index.clear();
     for (iterator it = begin(), itEnd = end(); it != itEnd; ++it)
         delete *it;
     clear();
@@ -536,6 +825,9 @@ void CNfcConfig::clean()
 *******************************************************************************/
 void CNfcConfig::add(const CNfcParam* pParam)
 {
+#ifdef NFC_CONFIG_CACHE
+    m_parsed.push_back(pParam);
+#endif
     if (m_list.size() == 0)
     {
         m_list.push_back(pParam);
@@ -568,6 +860,43 @@ void CNfcConfig::moveFromList()
     for (list<const CNfcParam*>::iterator it = m_list.begin(), itEnd = m_list.end(); it != itEnd; ++it)
         push_back(*it);
     m_list.clear();
+    buildIndex();
+}
+
+/*******************************************************************************
+**
+** Function:    CNfcConfig::buildIndex()
+**
+** Description: hash every setting name of the array into m_index; when a name
+**              is present more than once the first entry is kept, as the
+**              linear search used to return
+**
+** Returns:     none
+**
+*******************************************************************************/
+void CNfcConfig::buildIndex()
+{
+    size_t slots = 16;
+    while (slots < size() * 2)
+        slots <<= 1;
+
+    CNfcIndexSlot empty = {0, NULL};
+    m_index.assign(slots, empty);
+
+    size_t mask = slots - 1;
+    for (const_iterator it = begin(), itEnd = end(); it != itEnd; ++it)
+    {
+        unsigned long hash = hashName((*it)->c_str());
+        size_t i = hash & mask;
+
+        while (m_index[i].param != NULL &&
+               (m_index[i].hash != hash || *m_index[i].param != *(*it)))
+            i = (i + 1) & mask;
+        if (m_index[i].param != NULL)
+            continue;
+        m_index[i].hash = hash;
+        m_index[i].param = *it;
+    }
 }
 
 /*******************************************************************************
@@ -581,6 +910,7 @@ void CNfcConfig::moveFromList()
 *******************************************************************************/
 void CNfcConfig::moveToList()
 {
+    m_index.clear();
     if (m_list.size() != 0)
         m_list.clear();
 
@@ -344,17 +344,49 @@ typedef struct _tle
     TIMER_PARAM_TYPE   param;
     UINT16        event;
     UINT8         in_use;
+#if (GKI_TIMER_WHEEL == TRUE)
+    UINT32        expires;      /* expiration time in timer list units */
+    UINT16        wheel_slot;   /* wheel slot holding the entry, or GKI_TIMER_WHEEL_EXPIRED */
+#endif
 } TIMER_LIST_ENT;
 
+#if (GKI_TIMER_WHEEL == TRUE)
+/* Timer wheel geometry: GKI_TIMER_WHEEL_LEVELS levels of 2^GKI_TIMER_WHEEL_BITS
+** slots each. Timeouts beyond the wheel range are cascaded again when they
+** reach the last level.
+*/
+#define GKI_TIMER_WHEEL_BITS        6
+#define GKI_TIMER_WHEEL_LEVELS      4
+#define GKI_TIMER_WHEEL_SLOTS       (1 << GKI_TIMER_WHEEL_BITS)
+#define GKI_TIMER_WHEEL_MASK        (GKI_TIMER_WHEEL_SLOTS - 1)
+#define GKI_TIMER_WHEEL_RANGE       (1UL << (GKI_TIMER_WHEEL_BITS * GKI_TIMER_WHEEL_LEVELS))
+#define GKI_TIMER_WHEEL_EXPIRED     0xFFFF
+#endif
+
 /* Define a timer list queue
+**
+** With GKI_TIMER_WHEEL, p_first/p_last only hold the expired entries (ticks
+** of 0) and the running entries are hashed into the wheel. An all-zero queue
+** is a valid empty queue in both implementations.
 */
 typedef struct
 {
     TIMER_LIST_ENT   *p_first;
     TIMER_LIST_ENT   *p_last;
     INT32             last_ticks;
+#if (GKI_TIMER_WHEEL == TRUE)
+    UINT32            cur_time;         /* current time in timer list units */
+    UINT16            num_pending;      /* number of entries in the wheel */
+    TIMER_LIST_ENT   *wheel[GKI_TIMER_WHEEL_LEVELS * GKI_TIMER_WHEEL_SLOTS];
+#endif
 } TIMER_LIST_Q;
 
+#if (GKI_TIMER_WHEEL == TRUE)
+#define GKI_IS_TIMER_LIST_EMPTY(p_q) (((p_q)->p_first == NULL) && ((p_q)->num_pending == 0))
+#else
+#define GKI_IS_TIMER_LIST_EMPTY(p_q) ((p_q)->p_first == NULL)
+#endif
+
 
 /***********************************************************************
 ** This queue is a general purpose buffer queue, for application use.
@@ -368,6 +400,24 @@ typedef struct
 
 #define GKI_IS_QUEUE_EMPTY(p_q) ((p_q)->count == 0)
 
+/***********************************************************************
+** Buffer pool statistics, returned by GKI_get_pool_stats().
+*/
+#define GKI_STATS_OTHER_TASK    GKI_MAX_TASKS   /* task_alloc_cnt[] entry for threads which are not GKI tasks */
+
+typedef struct
+{
+    UINT16   size;                                  /* size of the buffers in the pool */
+    UINT16   total;                                 /* total number of buffers in the pool */
+    UINT16   cur_cnt;                               /* number of buffers currently allocated */
+    UINT16   max_cnt;                               /* high-water mark of allocated buffers */
+    BOOLEAN  restricted;                            /* TRUE if GKI_getbuf() does not use the pool */
+    UINT32   alloc_cnt;                             /* number of buffers allocated from the pool */
+    UINT32   fail_cnt;                              /* number of times the pool was found empty */
+    UINT32   fallback_cnt;                          /* number of requests for the pool served by another pool */
+    UINT32   task_alloc_cnt[GKI_MAX_TASKS + 1];     /* allocations per owner task */
+} tGKI_POOL_STATS;
+
 /* Task constants
 */
 #ifndef TASKPTR
@@ -439,6 +489,11 @@ GKI_API extern UINT16  GKI_poolfreecount (UINT8);
 GKI_API extern UINT16  GKI_poolutilization (UINT8);
 GKI_API extern void    GKI_register_mempool (void *p_mem);
 GKI_API extern UINT8   GKI_set_pool_permission(UINT8, UINT8);
+#if (GKI_POOL_STATS == TRUE)
+GKI_API extern BOOLEAN GKI_get_pool_stats (UINT8, tGKI_POOL_STATS *);
+GKI_API extern void    GKI_reset_pool_stats (void);
+GKI_API extern void    GKI_dump_pool_stats (void);
+#endif
 
 
 /* User buffer queue management
@@ -25,6 +25,7 @@
 #if (!defined(BTU_STACK_LITE_ENABLED) || BTU_STACK_LITE_ENABLED == FALSE)
 static void gki_add_to_pool_list(UINT8 pool_id);
 static void gki_remove_from_pool_list(UINT8 pool_id);
+static void gki_update_size_classes(void);
 #endif /*  BTU_STACK_LITE_ENABLED == FALSE */
 
 #if GKI_BUFFER_DEBUG
@@ -57,10 +58,9 @@ static void gki_init_free_queue (UINT8 id, UINT16 size, UINT16 total, void *p_me
     tempsize = (INT32)ALIGN_POOL(size);
     act_size = (UINT16)(tempsize + BUFFER_PADDING_SIZE);
 
-    /* Remember pool start and end addresses */
+    /* Remember pool end address, the start is published once the pool is set up */
     if(p_mem)
     {
-        p_cb->pool_start[id] = (UINT8 *)p_mem;
         p_cb->pool_end[id]   = (UINT8 *)p_mem + (act_size * total);
     }
 
@@ -93,6 +93,13 @@ static void gki_init_free_queue (UINT8 id, UINT16 size, UINT16 total, void *p_me
         }
         hdr1->p_next = NULL;
         p_cb->freeq[id].p_last = hdr1;
+#if (GKI_LOCK_FREE_POOLS == TRUE)
+        /* publish the free list once it is fully linked */
+        __sync_lock_test_and_set(&p_cb->freeq[id].free_head, (total) ? 1 : 0);
+#endif
+        /* gki_pool_get() skips the deferred allocation once it sees the pool
+           start, so it has to be the last store */
+        __atomic_store_n(&p_cb->pool_start[id], (UINT8 *)p_mem, __ATOMIC_RELEASE);
     }
     return;
 }
@@ -106,9 +113,9 @@ static BOOLEAN gki_alloc_free_queue(UINT8 id)
         ALOGD("\ngki_alloc_free_queue in, id:%d \n", id);
     #endif
 
-    Q = &p_cb->freeq[p_cb->pool_list[id]];
+    Q = &p_cb->freeq[id];
 
-    if(Q->p_first == 0)
+    if(p_cb->pool_start[id] == NULL)
     {
         void* p_mem = GKI_os_malloc((Q->size + BUFFER_PADDING_SIZE) * Q->total);
         if(p_mem)
@@ -154,6 +161,9 @@ void gki_buffer_init(void)
         {
             p_cb->OSTaskQFirst[tt][mb] = NULL;
             p_cb->OSTaskQLast [tt][mb] = NULL;
+#if (GKI_LOCK_FREE_MBOX == TRUE)
+            p_cb->OSTaskQIn   [tt][mb] = NULL;
+#endif
         }
     }
 
@@ -169,6 +179,9 @@ void gki_buffer_init(void)
         p_cb->freeq[tt].total   = 0;
         p_cb->freeq[tt].cur_cnt = 0;
         p_cb->freeq[tt].max_cnt = 0;
+#if (GKI_LOCK_FREE_POOLS == TRUE)
+        p_cb->freeq[tt].free_head = 0;
+#endif
     }
 
     /* Use default from target.h */
@@ -315,10 +328,263 @@ void gki_buffer_init(void)
 
     p_cb->curr_total_no_of_pools = GKI_NUM_FIXED_BUF_POOLS;
 
+    gki_update_size_classes();
+
     return;
 }
 
 
+#if (GKI_LOCK_FREE_POOLS == TRUE)
+/* Lock-free free queue head: index + 1 of the first free buffer in the low
+** 16 bits (0 if empty), and a tag in the high 16 bits which is bumped on
+** every update so that a stale head cannot be swapped back in (ABA).
+*/
+#define GKI_FREE_HEAD_IDX(h)    ((h) & 0xFFFF)
+#define GKI_FREE_HEAD_TAG(h)    ((h) & 0xFFFF0000)
+#define GKI_FREE_HEAD_TAG_INC   0x10000
+
+/*******************************************************************************
+**
+** Function         gki_free_head_hdr
+**
+** Description      Convert the index part of a free queue head to the address
+**                  of the buffer header.
+**
+** Returns          buffer header, or NULL if the index is 0 (empty)
+**
+*******************************************************************************/
+static BUFFER_HDR_T *gki_free_head_hdr (UINT8 pool_id, UINT32 head)
+{
+    tGKI_COM_CB *p_cb = &gki_cb.com;
+
+    if (GKI_FREE_HEAD_IDX(head) == 0)
+        return (NULL);
+
+    return ((BUFFER_HDR_T *)(p_cb->pool_start[pool_id] + (GKI_FREE_HEAD_IDX(head) - 1) * p_cb->pool_size[pool_id]));
+}
+
+/*******************************************************************************
+**
+** Function         gki_free_head_idx
+**
+** Description      Convert the address of a buffer header to its free queue
+**                  index (position in the pool + 1).
+**
+** Returns          index, or 0 for NULL
+**
+*******************************************************************************/
+static UINT32 gki_free_head_idx (UINT8 pool_id, BUFFER_HDR_T *p_hdr)
+{
+    tGKI_COM_CB *p_cb = &gki_cb.com;
+
+    if (p_hdr == NULL)
+        return (0);
+
+    return (GKI_FREE_HEAD_IDX((UINT32)((UINT8 *)p_hdr - p_cb->pool_start[pool_id]) / p_cb->pool_size[pool_id] + 1));
+}
+#endif
+
+/*******************************************************************************
+**
+** Function         gki_pool_get
+**
+** Description      Take a buffer off the free queue of a pool and update the
+**                  pool usage counters. The pool memory is allocated on first
+**                  use if GKI_USE_DEFERED_ALLOC_BUF_POOLS is defined.
+**
+**                  With GKI_LOCK_FREE_POOLS the free queue is a lock-free stack
+**                  and the GKI mutex is only taken to allocate the pool memory.
+**
+** Returns          the buffer header, or NULL if the pool is empty
+**
+*******************************************************************************/
+static BUFFER_HDR_T *gki_pool_get (UINT8 pool_id)
+{
+    tGKI_COM_CB   *p_cb = &gki_cb.com;
+    FREE_QUEUE_T  *Q = &p_cb->freeq[pool_id];
+    BUFFER_HDR_T  *p_hdr = NULL;
+#if (GKI_LOCK_FREE_POOLS == TRUE)
+    UINT32         head;
+    UINT32         next;
+    UINT16         cnt;
+    UINT16         max;
+
+#ifdef GKI_USE_DEFERED_ALLOC_BUF_POOLS
+    /* pairs with the release store in gki_init_free_queue() */
+    if ((__atomic_load_n(&p_cb->pool_start[pool_id], __ATOMIC_ACQUIRE) == NULL) && (Q->total))
+    {
+        GKI_disable();
+        if ((p_cb->pool_start[pool_id] == NULL) && (gki_alloc_free_queue(pool_id) != TRUE))
+        {
+            GKI_enable();
+            GKI_TRACE_ERROR_0("gki_pool_get() fail alloc free queue");
+            return (NULL);
+        }
+        GKI_enable();
+    }
+#endif
+
+    do
+    {
+        head  = Q->free_head;
+        p_hdr = gki_free_head_hdr(pool_id, head);
+        if (p_hdr == NULL)
+            break;
+
+        /* p_next may be stale if another thread takes this buffer first; the tag makes the swap fail then */
+        next = (GKI_FREE_HEAD_TAG(head) + GKI_FREE_HEAD_TAG_INC) | gki_free_head_idx(pool_id, p_hdr->p_next);
+    } while (!__sync_bool_compare_and_swap(&Q->free_head, head, next));
+
+    if (p_hdr)
+    {
+        cnt = __sync_add_and_fetch(&Q->cur_cnt, 1);
+        while (((max = Q->max_cnt) < cnt) && !__sync_bool_compare_and_swap(&Q->max_cnt, max, cnt))
+            ;
+    }
+#else
+    GKI_disable();
+
+    if (Q->cur_cnt < Q->total)
+    {
+#ifdef GKI_USE_DEFERED_ALLOC_BUF_POOLS
+        if (Q->p_first == 0 && gki_alloc_free_queue(pool_id) != TRUE)
+        {
+            GKI_enable();
+            return (NULL);
+        }
+#endif
+
+        if (Q->p_first == 0)
+        {
+            /* gki_alloc_free_queue() failed to alloc memory */
+            GKI_enable();
+            GKI_TRACE_ERROR_0("gki_pool_get() fail alloc free queue");
+            return (NULL);
+        }
+
+        p_hdr = Q->p_first;
+        Q->p_first = p_hdr->p_next;
+
+        if (!Q->p_first)
+            Q->p_last = NULL;
+
+        if(++Q->cur_cnt > Q->max_cnt)
+            Q->max_cnt = Q->cur_cnt;
+    }
+
+    GKI_enable();
+#endif
+
+#if (GKI_POOL_STATS == TRUE)
+    if (p_hdr)
+        __sync_add_and_fetch(&p_cb->pool_stats[pool_id].alloc_cnt, 1);
+    else
+        __sync_add_and_fetch(&p_cb->pool_stats[pool_id].fail_cnt, 1);
+#endif
+
+    return (p_hdr);
+}
+
+#if (GKI_POOL_STATS == TRUE)
+/*******************************************************************************
+**
+** Function         gki_pool_stats_owner
+**
+** Description      Count an allocated buffer against its owner task.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_pool_stats_owner (BUFFER_HDR_T *p_hdr)
+{
+    UINT8 task_id = (p_hdr->task_id < GKI_MAX_TASKS) ? p_hdr->task_id : GKI_STATS_OTHER_TASK;
+
+    __sync_add_and_fetch(&gki_cb.com.pool_stats[p_hdr->q_id].task_alloc_cnt[task_id], 1);
+}
+#endif
+
+/*******************************************************************************
+**
+** Function         gki_pool_put
+**
+** Description      Return a buffer to the free queue of its pool and update the
+**                  pool usage counter.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_pool_put (UINT8 pool_id, BUFFER_HDR_T *p_hdr)
+{
+    FREE_QUEUE_T  *Q = &gki_cb.com.freeq[pool_id];
+#if (GKI_LOCK_FREE_POOLS == TRUE)
+    UINT32         head;
+    UINT32         next;
+    UINT16         cnt;
+
+    p_hdr->status  = BUF_STATUS_FREE;
+    p_hdr->task_id = GKI_INVALID_TASK;
+
+    do
+    {
+        head = Q->free_head;
+        p_hdr->p_next = gki_free_head_hdr(pool_id, head);
+        next = (GKI_FREE_HEAD_TAG(head) + GKI_FREE_HEAD_TAG_INC) | gki_free_head_idx(pool_id, p_hdr);
+    } while (!__sync_bool_compare_and_swap(&Q->free_head, head, next));
+
+    do
+    {
+        cnt = Q->cur_cnt;
+    } while ((cnt > 0) && !__sync_bool_compare_and_swap(&Q->cur_cnt, cnt, cnt - 1));
+#else
+    GKI_disable();
+
+    if (Q->p_last)
+        Q->p_last->p_next = p_hdr;
+    else
+        Q->p_first = p_hdr;
+
+    Q->p_last      = p_hdr;
+    p_hdr->p_next  = NULL;
+    p_hdr->status  = BUF_STATUS_FREE;
+    p_hdr->task_id = GKI_INVALID_TASK;
+    if (Q->cur_cnt > 0)
+        Q->cur_cnt--;
+
+    GKI_enable();
+#endif
+}
+
+#if (GKI_LOCK_FREE_MBOX == TRUE)
+/*******************************************************************************
+**
+** Function         gki_mbox_post
+**
+** Description      Push a buffer onto the posting list of a task mailbox. The
+**                  posting list is a lock-free stack which the receiving task
+**                  takes over as a whole in GKI_read_mbox().
+**
+** Returns          TRUE if the mailbox had no pending posts, i.e. the receiving
+**                  task needs a mailbox event to pick up the buffer
+**
+*******************************************************************************/
+static BOOLEAN gki_mbox_post (UINT8 task_id, UINT8 mbox, BUFFER_HDR_T *p_hdr)
+{
+    BUFFER_HDR_T * volatile *pp_in = &gki_cb.com.OSTaskQIn[task_id][mbox];
+    BUFFER_HDR_T            *p_old;
+
+    p_hdr->status  = BUF_STATUS_QUEUED;
+    p_hdr->task_id = task_id;
+
+    do
+    {
+        p_old = *pp_in;
+        p_hdr->p_next = p_old;
+    } while (!__sync_bool_compare_and_swap(pp_in, p_old, p_hdr));
+
+    return (p_old == NULL);
+}
+#endif
+
 /*******************************************************************************
 **
 ** Function         GKI_init_q
@@ -363,6 +629,9 @@ void *GKI_getbuf (UINT16 size)
     FREE_QUEUE_T  *Q;
     BUFFER_HDR_T  *p_hdr;
     tGKI_COM_CB *p_cb = &gki_cb.com;
+#if (GKI_POOL_STATS == TRUE)
+    UINT8         first_pool = GKI_INVALID_POOL;
+#endif
 #if GKI_BUFFER_DEBUG
     UINT8         x;
 #endif
@@ -376,21 +645,15 @@ void *GKI_getbuf (UINT16 size)
 #if GKI_BUFFER_DEBUG
     LOGD("GKI_getbuf() requesting %d func:%s(line=%d)", size, _function_, _line_);
 #endif
-    /* Find the first buffer pool that is public that can hold the desired size */
-    for (i=0; i < p_cb->curr_total_no_of_pools; i++)
-    {
-        if ( size <= p_cb->freeq[p_cb->pool_list[i]].size )
-            break;
-    }
-
-    if(i == p_cb->curr_total_no_of_pools)
+    if (size > p_cb->max_pool_buf_size)
     {
         GKI_exception (GKI_ERROR_BUF_SIZE_TOOBIG, "getbuf: Size is too big");
         return (NULL);
     }
 
-    /* Make sure the buffers aren't disturbed til finished with allocation */
-    GKI_disable();
+    /* Look up the first public buffer pool that can hold the size class. Pools
+     * before it in pool_list are restricted or too small for any size of the class. */
+    i = p_cb->size_class_pos[GKI_BUF_SIZE_CLASS(size)];
 
     /* search the public buffer pools that are big enough to hold the size
      * until a free buffer is found */
@@ -401,39 +664,27 @@ void *GKI_getbuf (UINT16 size)
             continue;
 
         Q = &p_cb->freeq[p_cb->pool_list[i]];
-        if(Q->cur_cnt < Q->total)
-        {
-        #ifdef GKI_USE_DEFERED_ALLOC_BUF_POOLS
-            if(Q->p_first == 0 && gki_alloc_free_queue(i) != TRUE)
-            {
-                GKI_TRACE_ERROR_0("GKI_getbuf() out of buffer");
-                return NULL;
-            }
-        #endif
-
-            if(Q->p_first == 0)
-            {
-                /* gki_alloc_free_queue() failed to alloc memory */
-                GKI_TRACE_ERROR_0("GKI_getbuf() fail alloc free queue");
-                return NULL;
-            }
-
-            p_hdr = Q->p_first;
-            Q->p_first = p_hdr->p_next;
-
-            if (!Q->p_first)
-                Q->p_last = NULL;
-
-            if(++Q->cur_cnt > Q->max_cnt)
-                Q->max_cnt = Q->cur_cnt;
+        if (size > Q->size)
+            continue;
 
-            GKI_enable();
+#if (GKI_POOL_STATS == TRUE)
+        if (first_pool == GKI_INVALID_POOL)
+            first_pool = p_cb->pool_list[i];
+#endif
 
+        if ((p_hdr = gki_pool_get(p_cb->pool_list[i])) != NULL)
+        {
             p_hdr->task_id = GKI_get_taskid();
 
             p_hdr->status  = BUF_STATUS_UNLINKED;
             p_hdr->p_next  = NULL;
             p_hdr->Type    = 0;
+
+#if (GKI_POOL_STATS == TRUE)
+            gki_pool_stats_owner(p_hdr);
+            if (first_pool != p_hdr->q_id)
+                __sync_add_and_fetch(&p_cb->pool_stats[first_pool].fallback_cnt, 1);
+#endif
 #if GKI_BUFFER_DEBUG
             LOGD("GKI_getbuf() allocated, %x, %x (%d of %d used) %d", (UINT8*)p_hdr + BUFFER_HDR_SIZE, p_hdr, Q->cur_cnt, Q->total, p_cb->freeq[i].total);
 
@@ -475,8 +726,6 @@ void *GKI_getbuf (UINT16 size)
 
     GKI_TRACE_ERROR_0("Failed to allocate GKI buffer");
 
-    GKI_enable();
-
     return (NULL);
 }
 
@@ -502,8 +751,8 @@ void *GKI_getpoolbuf_debug (UINT8 pool_id, const char * _function_, int _line_)
 void *GKI_getpoolbuf (UINT8 pool_id)
 #endif
 {
-    FREE_QUEUE_T  *Q;
     BUFFER_HDR_T  *p_hdr;
+    void          *p_buf;
     tGKI_COM_CB *p_cb = &gki_cb.com;
 
     if (pool_id >= GKI_NUM_TOTAL_BUF_POOLS)
@@ -512,44 +761,20 @@ void *GKI_getpoolbuf (UINT8 pool_id)
 #if GKI_BUFFER_DEBUG
     LOGD("GKI_getpoolbuf() requesting from %d func:%s(line=%d)", pool_id, _function_, _line_);
 #endif
-    /* Make sure the buffers aren't disturbed til finished with allocation */
-    GKI_disable();
-
-    Q = &p_cb->freeq[pool_id];
-    if(Q->cur_cnt < Q->total)
+    if ((p_hdr = gki_pool_get(pool_id)) != NULL)
     {
-#ifdef GKI_USE_DEFERED_ALLOC_BUF_POOLS
-        if(Q->p_first == 0 && gki_alloc_free_queue(pool_id) != TRUE)
-            return NULL;
-#endif
-
-        if(Q->p_first == 0)
-        {
-            /* gki_alloc_free_queue() failed to alloc memory */
-            GKI_TRACE_ERROR_0("GKI_getpoolbuf() fail alloc free queue");
-            return NULL;
-        }
-
-        p_hdr = Q->p_first;
-        Q->p_first = p_hdr->p_next;
-
-        if (!Q->p_first)
-            Q->p_last = NULL;
-
-        if(++Q->cur_cnt > Q->max_cnt)
-            Q->max_cnt = Q->cur_cnt;
-
-        GKI_enable();
-
-
         p_hdr->task_id = GKI_get_taskid();
 
         p_hdr->status  = BUF_STATUS_UNLINKED;
         p_hdr->p_next  = NULL;
         p_hdr->Type    = 0;
 
+#if (GKI_POOL_STATS == TRUE)
+        gki_pool_stats_owner(p_hdr);
+#endif
+
 #if GKI_BUFFER_DEBUG
-        LOGD("GKI_getpoolbuf() allocated, %x, %x (%d of %d used) %d", (UINT8*)p_hdr + BUFFER_HDR_SIZE, p_hdr, Q->cur_cnt, Q->total, p_cb->freeq[pool_id].total);
+        LOGD("GKI_getpoolbuf() allocated, %x, %x (%d of %d used) %d", (UINT8*)p_hdr + BUFFER_HDR_SIZE, p_hdr, p_cb->freeq[pool_id].cur_cnt, p_cb->freeq[pool_id].total, p_cb->freeq[pool_id].total);
 
         strncpy(p_hdr->_function, _function_, _GKI_MAX_FUNCTION_NAME_LEN);
         p_hdr->_function[_GKI_MAX_FUNCTION_NAME_LEN] = '\0';
@@ -559,15 +784,21 @@ void *GKI_getpoolbuf (UINT8 pool_id)
     }
 
     /* If here, no buffers in the specified pool */
-    GKI_enable();
-
 #if GKI_BUFFER_DEBUG
     /* try for free buffers in public pools */
-    return (GKI_getbuf_debug(p_cb->freeq[pool_id].size, _function_, _line_));
+    p_buf = GKI_getbuf_debug(p_cb->freeq[pool_id].size, _function_, _line_);
 #else
     /* try for free buffers in public pools */
-    return (GKI_getbuf(p_cb->freeq[pool_id].size));
+    p_buf = GKI_getbuf(p_cb->freeq[pool_id].size);
 #endif
+
+#if (GKI_POOL_STATS == TRUE)
+    /* GKI_getbuf() already counts the fallback if the pool is public */
+    if ((p_buf) && (((UINT16)1 << pool_id) & p_cb->pool_access_mask))
+        __sync_add_and_fetch(&p_cb->pool_stats[pool_id].fallback_cnt, 1);
+#endif
+
+    return (p_buf);
 }
 
 /*******************************************************************************
@@ -583,7 +814,6 @@ void *GKI_getpoolbuf (UINT8 pool_id)
 *******************************************************************************/
 void GKI_freebuf (void *p_buf)
 {
-    FREE_QUEUE_T    *Q;
     BUFFER_HDR_T    *p_hdr;
 
 #if (GKI_ENABLE_BUF_CORRUPTION_CHECK == TRUE)
@@ -612,25 +842,10 @@ void GKI_freebuf (void *p_buf)
         return;
     }
 
-    GKI_disable();
-
     /*
     ** Release the buffer
     */
-    Q  = &gki_cb.com.freeq[p_hdr->q_id];
-    if (Q->p_last)
-        Q->p_last->p_next = p_hdr;
-    else
-        Q->p_first = p_hdr;
-
-    Q->p_last      = p_hdr;
-    p_hdr->p_next  = NULL;
-    p_hdr->status  = BUF_STATUS_FREE;
-    p_hdr->task_id = GKI_INVALID_TASK;
-    if (Q->cur_cnt > 0)
-        Q->cur_cnt--;
-
-    GKI_enable();
+    gki_pool_put(p_hdr->q_id, p_hdr);
 
     return;
 }
@@ -733,6 +948,12 @@ void GKI_send_msg (UINT8 task_id, UINT8 mbox, void *msg)
         return;
     }
 
+#if (GKI_LOCK_FREE_MBOX == TRUE)
+    /* only the first post to an idle mailbox needs an event; the task keeps
+     * reading until the mailbox is empty, which picks up any later posts */
+    if (gki_mbox_post(task_id, mbox, p_hdr))
+        GKI_send_event(task_id, (UINT16)EVENT_MASK(mbox));
+#else
     GKI_disable();
 
     if (p_cb->OSTaskQFirst[task_id][mbox])
@@ -750,6 +971,7 @@ void GKI_send_msg (UINT8 task_id, UINT8 mbox, void *msg)
     GKI_enable();
 
     GKI_send_event(task_id, (UINT16)EVENT_MASK(mbox));
+#endif
 
     return;
 }
@@ -771,10 +993,41 @@ void *GKI_read_mbox (UINT8 mbox)
     UINT8           task_id = GKI_get_taskid();
     void            *p_buf = NULL;
     BUFFER_HDR_T    *p_hdr;
+#if (GKI_LOCK_FREE_MBOX == TRUE)
+    BUFFER_HDR_T    *p_in;
+    BUFFER_HDR_T    *p_next;
+#endif
 
     if ((task_id >= GKI_MAX_TASKS) || (mbox >= NUM_TASK_MBOX))
         return (NULL);
 
+#if (GKI_LOCK_FREE_MBOX == TRUE)
+    /* OSTaskQFirst is only touched by the receiving task */
+    p_hdr = gki_cb.com.OSTaskQFirst[task_id][mbox];
+
+    if (p_hdr == NULL)
+    {
+        /* take over all the posts since the last read and put them in send order */
+        p_in = __sync_lock_test_and_set(&gki_cb.com.OSTaskQIn[task_id][mbox], NULL);
+        while (p_in)
+        {
+            p_next        = p_in->p_next;
+            p_in->p_next  = p_hdr;
+            p_hdr         = p_in;
+            p_in          = p_next;
+        }
+    }
+
+    if (p_hdr)
+    {
+        gki_cb.com.OSTaskQFirst[task_id][mbox] = p_hdr->p_next;
+
+        p_hdr->p_next = NULL;
+        p_hdr->status = BUF_STATUS_UNLINKED;
+
+        p_buf = (UINT8 *)p_hdr + BUFFER_HDR_SIZE;
+    }
+#else
     GKI_disable();
 
     if (gki_cb.com.OSTaskQFirst[task_id][mbox])
@@ -789,6 +1042,7 @@ void *GKI_read_mbox (UINT8 mbox)
     }
 
     GKI_enable();
+#endif
 
     return (p_buf);
 }
@@ -1153,6 +1407,8 @@ UINT8 GKI_set_pool_permission(UINT8 pool_id, UINT8 permission)
         else    /* mark the pool as public */
             p_cb->pool_access_mask = (UINT16)(p_cb->pool_access_mask & ~(1 << pool_id));
 
+        gki_update_size_classes();
+
         return (GKI_SUCCESS);
     }
     else
@@ -1223,6 +1479,46 @@ static void gki_remove_from_pool_list(UINT8 pool_id)
     return;
 }
 
+/*******************************************************************************
+**
+** Function         gki_update_size_classes
+**
+** Description      Rebuilds the size class table used by GKI_getbuf(). For each
+**                  size class it records the first position in the pool list of
+**                  a public pool which can hold the smallest size of the class.
+**                  Called whenever a pool is added, deleted or changes permission.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_update_size_classes(void)
+{
+    tGKI_COM_CB *p_cb = &gki_cb.com;
+    UINT16       xx;
+    UINT16       min_size;
+    UINT8        i;
+
+    p_cb->max_pool_buf_size = 0;
+    for (i = 0; i < p_cb->curr_total_no_of_pools; i++)
+    {
+        if (p_cb->freeq[p_cb->pool_list[i]].size > p_cb->max_pool_buf_size)
+            p_cb->max_pool_buf_size = p_cb->freeq[p_cb->pool_list[i]].size;
+    }
+
+    for (xx = 0; xx < GKI_NUM_BUF_SIZE_CLASSES; xx++)
+    {
+        min_size = (UINT16)((xx << GKI_BUF_SIZE_CLASS_SHIFT) + 1);
+
+        for (i = 0; i < p_cb->curr_total_no_of_pools; i++)
+        {
+            if (  (!(((UINT16)1 << p_cb->pool_list[i]) & p_cb->pool_access_mask))
+                &&(min_size <= p_cb->freeq[p_cb->pool_list[i]].size)  )
+                break;
+        }
+        p_cb->size_class_pos[xx] = i;
+    }
+}
+
 /*******************************************************************************
 **
 ** Function         GKI_igetpoolbuf
@@ -1237,31 +1533,23 @@ static void gki_remove_from_pool_list(UINT8 pool_id)
 *******************************************************************************/
 void *GKI_igetpoolbuf (UINT8 pool_id)
 {
-    FREE_QUEUE_T  *Q;
     BUFFER_HDR_T  *p_hdr;
 
     if (pool_id >= GKI_NUM_TOTAL_BUF_POOLS)
         return (NULL);
 
-
-    Q = &gki_cb.com.freeq[pool_id];
-    if(Q->cur_cnt < Q->total)
+    if ((p_hdr = gki_pool_get(pool_id)) != NULL)
     {
-        p_hdr = Q->p_first;
-        Q->p_first = p_hdr->p_next;
-
-        if (!Q->p_first)
-            Q->p_last = NULL;
-
-        if(++Q->cur_cnt > Q->max_cnt)
-            Q->max_cnt = Q->cur_cnt;
-
         p_hdr->task_id = GKI_get_taskid();
 
         p_hdr->status  = BUF_STATUS_UNLINKED;
         p_hdr->p_next  = NULL;
         p_hdr->Type    = 0;
 
+#if (GKI_POOL_STATS == TRUE)
+        gki_pool_stats_owner(p_hdr);
+#endif
+
         return ((void *) ((UINT8 *)p_hdr + BUFFER_HDR_SIZE));
     }
 
@@ -1380,6 +1668,10 @@ void GKI_isend_msg (UINT8 task_id, UINT8 mbox, void *msg)
         return;
     }
 
+#if (GKI_LOCK_FREE_MBOX == TRUE)
+    if (gki_mbox_post(task_id, mbox, p_hdr))
+        GKI_isend_event(task_id, (UINT16)EVENT_MASK(mbox));
+#else
     if (p_cb->OSTaskQFirst[task_id][mbox])
         p_cb->OSTaskQLast[task_id][mbox]->p_next = p_hdr;
     else
@@ -1392,6 +1684,7 @@ void GKI_isend_msg (UINT8 task_id, UINT8 mbox, void *msg)
     p_hdr->task_id = task_id;
 
     GKI_isend_event(task_id, (UINT16)EVENT_MASK(mbox));
+#endif
 
     return;
 }
@@ -1450,6 +1743,7 @@ UINT8 GKI_create_pool (UINT16 size, UINT16 count, UINT8 permission, void *p_mem_
         gki_add_to_pool_list(xx);
         (void) GKI_set_pool_permission (xx, permission);
         p_cb->curr_total_no_of_pools++;
+        gki_update_size_classes();
 
         return (xx);
     }
@@ -1489,6 +1783,9 @@ void GKI_delete_pool (UINT8 pool_id)
         Q->max_cnt   = 0;
         Q->p_first   = NULL;
         Q->p_last    = NULL;
+#if (GKI_LOCK_FREE_POOLS == TRUE)
+        Q->free_head = 0;
+#endif
 
         GKI_os_free (p_cb->pool_start[pool_id]);
 
@@ -1498,6 +1795,7 @@ void GKI_delete_pool (UINT8 pool_id)
 
         gki_remove_from_pool_list(pool_id);
         p_cb->curr_total_no_of_pools--;
+        gki_update_size_classes();
     }
     else
         GKI_exception(GKI_ERROR_DELETE_POOL_BAD_QID, "Deleting bad pool");
@@ -1555,3 +1853,118 @@ UINT16 GKI_poolutilization (UINT8 pool_id)
     return ((Q->cur_cnt * 100) / Q->total);
 }
 
+#if (GKI_POOL_STATS == TRUE)
+/*******************************************************************************
+**
+** Function         GKI_get_pool_stats
+**
+** Description      Called by an application to get the allocation statistics
+**                  of a buffer pool since startup or the last call to
+**                  GKI_reset_pool_stats().
+**
+** Parameters       pool_id - (input) pool ID to get the statistics of.
+**                  p_stats - (output) statistics of the pool
+**
+** Returns          FALSE if the pool ID is not valid, else TRUE
+**
+*******************************************************************************/
+BOOLEAN GKI_get_pool_stats (UINT8 pool_id, tGKI_POOL_STATS *p_stats)
+{
+    tGKI_COM_CB  *p_cb = &gki_cb.com;
+    FREE_QUEUE_T *Q;
+
+    if ((pool_id >= GKI_NUM_TOTAL_BUF_POOLS) || (p_stats == NULL))
+        return (FALSE);
+
+    Q = &p_cb->freeq[pool_id];
+
+    memcpy(p_stats, &p_cb->pool_stats[pool_id], sizeof(tGKI_POOL_STATS));
+    p_stats->size       = Q->size;
+    p_stats->total      = Q->total;
+    p_stats->cur_cnt    = Q->cur_cnt;
+    p_stats->max_cnt    = Q->max_cnt;
+    p_stats->restricted = (((UINT16)1 << pool_id) & p_cb->pool_access_mask) ? TRUE : FALSE;
+
+    return (TRUE);
+}
+
+/*******************************************************************************
+**
+** Function         GKI_reset_pool_stats
+**
+** Description      Called by an application to clear the buffer pool statistics,
+**                  e.g. before replaying a workload. The high-water mark of
+**                  each pool restarts from the number of buffers in use.
+**
+** Returns          void
+**
+*******************************************************************************/
+void GKI_reset_pool_stats (void)
+{
+    tGKI_COM_CB *p_cb = &gki_cb.com;
+    UINT8        xx;
+
+    GKI_disable();
+
+    memset(p_cb->pool_stats, 0, sizeof(p_cb->pool_stats));
+    for (xx = 0; xx < GKI_NUM_TOTAL_BUF_POOLS; xx++)
+        p_cb->freeq[xx].max_cnt = p_cb->freeq[xx].cur_cnt;
+
+    GKI_enable();
+}
+
+/*******************************************************************************
+**
+** Function         GKI_dump_pool_stats
+**
+** Description      Logs the buffer pool statistics, one line per pool plus one
+**                  line of per task allocation counts for each pool in use.
+**                  The log does not depend on GKI_DEBUG or GKI_BUFFER_DEBUG.
+**
+** Returns          void
+**
+*******************************************************************************/
+void GKI_dump_pool_stats (void)
+{
+    tGKI_POOL_STATS stats;
+    char            buf[GKI_MAX_TASKS * 12 + 16];
+    int             len;
+    UINT8           xx;
+    UINT8           task_id;
+
+    LogMsg(TRACE_CTRL_GENERAL | TRACE_LAYER_GKI | TRACE_ORG_GKI | TRACE_TYPE_GENERIC,
+           "GKI pool stats: POOL  SIZE  TOTAL  CUR  MAX  ALLOC  FAIL  FALLBACK");
+
+    for (xx = 0; xx < GKI_NUM_TOTAL_BUF_POOLS; xx++)
+    {
+        if ((!GKI_get_pool_stats(xx, &stats)) || (stats.total == 0))
+            continue;
+
+        LogMsg(TRACE_CTRL_GENERAL | TRACE_LAYER_GKI | TRACE_ORG_GKI | TRACE_TYPE_GENERIC,
+               "GKI pool stats: %2u(%c) %5u %5u %4u %4u %6lu %5lu %8lu",
+               xx, (stats.restricted) ? 'R' : 'P', stats.size, stats.total, stats.cur_cnt, stats.max_cnt,
+               (unsigned long)stats.alloc_cnt, (unsigned long)stats.fail_cnt, (unsigned long)stats.fallback_cnt);
+
+        /* owner tasks as "task:count", "x" for threads which are not GKI tasks */
+        len = 0;
+        for (task_id = 0; task_id <= GKI_STATS_OTHER_TASK; task_id++)
+        {
+            if (stats.task_alloc_cnt[task_id] == 0)
+                continue;
+
+            if (task_id == GKI_STATS_OTHER_TASK)
+                len += snprintf(buf + len, sizeof(buf) - len, " x:%lu", (unsigned long)stats.task_alloc_cnt[task_id]);
+            else
+                len += snprintf(buf + len, sizeof(buf) - len, " %u:%lu", task_id, (unsigned long)stats.task_alloc_cnt[task_id]);
+
+            if (len >= (int)sizeof(buf))
+                break;
+        }
+
+        if (len)
+            LogMsg(TRACE_CTRL_GENERAL | TRACE_LAYER_GKI | TRACE_ORG_GKI | TRACE_TYPE_GENERIC,
+                   "GKI pool stats: %2u owners%s", xx, buf);
+    }
+}
+#endif
+
@@ -83,8 +83,11 @@ typedef struct _free_queue
     BUFFER_HDR_T *p_last;       /* last buffer in the queue */
     UINT16          size;          /* size of the buffers in the pool */
     UINT16          total;         /* toatal number of buffers */
-    UINT16          cur_cnt;       /* number of  buffers currently allocated */
-    UINT16          max_cnt;       /* maximum number of buffers allocated at any time */
+    volatile UINT16 cur_cnt;       /* number of  buffers currently allocated */
+    volatile UINT16 max_cnt;       /* maximum number of buffers allocated at any time */
+#if (GKI_LOCK_FREE_POOLS == TRUE)
+    volatile UINT32 free_head;     /* lock-free stack head: ABA tag (upper 16 bits), index + 1 of first free buffer (lower 16 bits) */
+#endif
 } FREE_QUEUE_T;
 
 
@@ -96,12 +99,29 @@ typedef struct _free_queue
 #define MAX_USER_BUF_SIZE   ((UINT16)0xffff - BUFFER_PADDING_SIZE)  /* pool size must allow for header */
 #define MAGIC_NO            0xDDBADDBA
 
+/* GKI_getbuf() size classes. Class n holds the sizes from
+** (n << GKI_BUF_SIZE_CLASS_SHIFT) + 1 to (n + 1) << GKI_BUF_SIZE_CLASS_SHIFT;
+** larger sizes share the last class.
+*/
+#define GKI_BUF_SIZE_CLASS_SHIFT    5
+#define GKI_NUM_BUF_SIZE_CLASSES    128
+#define GKI_BUF_SIZE_CLASS(size)    ((((size) - 1) >> GKI_BUF_SIZE_CLASS_SHIFT) < GKI_NUM_BUF_SIZE_CLASSES ? \
+                                     (((size) - 1) >> GKI_BUF_SIZE_CLASS_SHIFT) : (GKI_NUM_BUF_SIZE_CLASSES - 1))
+
 #define BUF_STATUS_FREE     0
 #define BUF_STATUS_UNLINKED 1
 #define BUF_STATUS_QUEUED   2
 
 #define GKI_USE_DEFERED_ALLOC_BUF_POOLS
 
+/* TRUE if there is a message waiting in a task mailbox
+*/
+#if (GKI_LOCK_FREE_MBOX == TRUE)
+#define GKI_MBOX_HAS_MSG(task_id, mbox) ((gki_cb.com.OSTaskQFirst[task_id][mbox] != NULL) || (gki_cb.com.OSTaskQIn[task_id][mbox] != NULL))
+#else
+#define GKI_MBOX_HAS_MSG(task_id, mbox) (gki_cb.com.OSTaskQFirst[task_id][mbox] != NULL)
+#endif
+
 /* Exception related structures (Used in debug mode only)
 */
 #if (GKI_DEBUG == TRUE)
@@ -309,6 +329,9 @@ typedef struct
     */
     BUFFER_HDR_T    *OSTaskQFirst[GKI_MAX_TASKS][NUM_TASK_MBOX]; /* array of pointers to the first event in the task mailbox */
     BUFFER_HDR_T    *OSTaskQLast [GKI_MAX_TASKS][NUM_TASK_MBOX]; /* array of pointers to the last event in the task mailbox */
+#if (GKI_LOCK_FREE_MBOX == TRUE)
+    BUFFER_HDR_T * volatile OSTaskQIn[GKI_MAX_TASKS][NUM_TASK_MBOX]; /* messages posted since the last read, newest first */
+#endif
 
     /* Define the buffer pool management variables
     */
@@ -329,6 +352,11 @@ typedef struct
     UINT16      pool_access_mask;                   /* Bits are set if the corresponding buffer pool is a restricted pool */
     UINT8       pool_list[GKI_NUM_TOTAL_BUF_POOLS]; /* buffer pools arranged in the order of size */
     UINT8       curr_total_no_of_pools;             /* number of fixed buf pools + current number of dynamic pools */
+    UINT8       size_class_pos[GKI_NUM_BUF_SIZE_CLASSES]; /* first pool_list position of a public pool big enough for the smallest size of each class */
+    UINT16      max_pool_buf_size;                  /* size of the biggest buffer pool (public or restricted) */
+#if (GKI_POOL_STATS == TRUE)
+    tGKI_POOL_STATS pool_stats[GKI_NUM_TOTAL_BUF_POOLS]; /* allocation counters; the pool occupancy fields are filled in on request */
+#endif
 
     BOOLEAN     timer_nesting;                      /* flag to prevent timer interrupt nesting */
 
@@ -358,6 +386,11 @@ extern void      gki_buffer_init (void);
 extern void      gki_timers_init(void);
 extern void      gki_adjust_timer_count (INT32);
 
+#if (GKI_TICKLESS == TRUE)
+extern void      gki_tickless_sync (void);
+extern void      gki_tickless_rearm (void);
+#endif
+
 extern void    OSStartRdy(void);
 extern void	   OSCtxSw(void);
 extern void	   OSIntCtxSw(void);
@@ -15,6 +15,7 @@
  *  limitations under the License.
  *
  ******************************************************************************/
+#include <string.h>
 #include "gki_int.h"
 
 #ifndef BT_ERROR_TRACE_0
@@ -147,6 +148,10 @@ BOOLEAN gki_timers_is_timer_running(void)
 *******************************************************************************/
 UINT32  GKI_get_tick_count(void)
 {
+#if (GKI_TICKLESS == TRUE)
+    /* OSTicks is only advanced when the timer loop wakes up */
+    gki_tickless_sync ();
+#endif
     return gki_cb.com.OSTicks;
 }
 
@@ -214,6 +219,11 @@ void GKI_start_timer (UINT8 tnum, INT32 ticks, BOOLEAN is_continuous)
 
     GKI_disable();
 
+#if (GKI_TICKLESS == TRUE)
+    /* account for the ticks elapsed since the timer loop last woke up */
+    gki_tickless_sync ();
+#endif
+
     if(gki_timers_is_timer_running() == FALSE)
     {
 #if (defined(GKI_DELAY_STOP_SYS_TICK) && (GKI_DELAY_STOP_SYS_TICK > 0))
@@ -634,6 +644,11 @@ void GKI_init_timer_list (TIMER_LIST_Q *p_timer_listq)
     p_timer_listq->p_first    = NULL;
     p_timer_listq->p_last     = NULL;
     p_timer_listq->last_ticks = 0;
+#if (GKI_TIMER_WHEEL == TRUE)
+    p_timer_listq->cur_time    = 0;
+    p_timer_listq->num_pending = 0;
+    memset (p_timer_listq->wheel, 0, sizeof (p_timer_listq->wheel));
+#endif
 
     return;
 }
@@ -660,6 +675,362 @@ void GKI_init_timer_list_entry (TIMER_LIST_ENT  *p_tle)
 }
 
 
+#if (GKI_TIMER_WHEEL == TRUE)
+/*******************************************************************************
+**
+** Function         gki_timer_queue_add
+**
+** Description      Add a timer list queue to the array of active timer queues
+**                  if it is not already there.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_timer_queue_add (TIMER_LIST_Q *p_timer_listq)
+{
+    UINT8 tt;
+
+    /* if we already add this timer queue to the array */
+    for (tt = 0; tt < GKI_MAX_TIMER_QUEUES; tt++)
+    {
+         if (gki_cb.com.timer_queues[tt] == p_timer_listq)
+             return;
+    }
+    /* add this timer queue to the array */
+    for (tt = 0; tt < GKI_MAX_TIMER_QUEUES; tt++)
+    {
+         if (gki_cb.com.timer_queues[tt] == NULL)
+         {
+             gki_cb.com.timer_queues[tt] = p_timer_listq;
+             break;
+         }
+    }
+}
+
+/*******************************************************************************
+**
+** Function         gki_timer_queue_remove
+**
+** Description      Remove a timer list queue from the array of active timer
+**                  queues.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_timer_queue_remove (TIMER_LIST_Q *p_timer_listq)
+{
+    UINT8 tt;
+
+    for (tt = 0; tt < GKI_MAX_TIMER_QUEUES; tt++)
+    {
+        if (gki_cb.com.timer_queues[tt] == p_timer_listq)
+        {
+            gki_cb.com.timer_queues[tt] = NULL;
+            break;
+        }
+    }
+}
+
+/*******************************************************************************
+**
+** Function         gki_timer_wheel_place
+**
+** Description      Hash a running timer entry into the wheel slot matching its
+**                  expiration time. The level is chosen from the distance to
+**                  the current time; entries beyond the wheel range are put in
+**                  the farthest slot and placed again when it is cascaded.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_timer_wheel_place (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT *p_tle)
+{
+    UINT32  delta = p_tle->expires - p_timer_listq->cur_time;
+    UINT32  when  = p_tle->expires;
+    UINT16  level = 0;
+    UINT16  slot;
+
+    if (delta >= GKI_TIMER_WHEEL_RANGE)
+    {
+        delta = GKI_TIMER_WHEEL_RANGE - 1;
+        when  = p_timer_listq->cur_time + delta;
+    }
+
+    while (delta >= GKI_TIMER_WHEEL_SLOTS)
+    {
+        delta >>= GKI_TIMER_WHEEL_BITS;
+        level++;
+    }
+
+    slot = (level * GKI_TIMER_WHEEL_SLOTS) + ((when >> (level * GKI_TIMER_WHEEL_BITS)) & GKI_TIMER_WHEEL_MASK);
+
+    p_tle->wheel_slot = slot;
+    p_tle->p_prev     = NULL;
+    p_tle->p_next     = p_timer_listq->wheel[slot];
+    if (p_tle->p_next != NULL)
+        p_tle->p_next->p_prev = p_tle;
+    p_timer_listq->wheel[slot] = p_tle;
+}
+
+/*******************************************************************************
+**
+** Function         gki_timer_wheel_expire
+**
+** Description      Move a timer entry to the end of the expired list
+**                  (p_first/p_last) and set its tick value to '0'.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_timer_wheel_expire (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT *p_tle)
+{
+    p_tle->ticks      = 0;
+    p_tle->wheel_slot = GKI_TIMER_WHEEL_EXPIRED;
+    p_tle->p_next     = NULL;
+    p_tle->p_prev     = p_timer_listq->p_last;
+
+    if (p_timer_listq->p_last != NULL)
+        p_timer_listq->p_last->p_next = p_tle;
+    else
+        p_timer_listq->p_first = p_tle;
+
+    p_timer_listq->p_last = p_tle;
+}
+
+/*******************************************************************************
+**
+** Function         gki_timer_wheel_tick
+**
+** Description      Advance the wheel by one unit: cascade the higher level
+**                  slots reached by the new time, then expire the entries in
+**                  the current level 0 slot.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_timer_wheel_tick (TIMER_LIST_Q *p_timer_listq)
+{
+    TIMER_LIST_ENT  *p_tle;
+    TIMER_LIST_ENT  *p_next;
+    UINT32           now = ++p_timer_listq->cur_time;
+    UINT16           level;
+    UINT16           slot;
+
+    for (level = 1; level < GKI_TIMER_WHEEL_LEVELS; level++)
+    {
+        /* lower level has not wrapped around */
+        if ((now >> ((level - 1) * GKI_TIMER_WHEEL_BITS)) & GKI_TIMER_WHEEL_MASK)
+            break;
+
+        slot  = (level * GKI_TIMER_WHEEL_SLOTS) + ((now >> (level * GKI_TIMER_WHEEL_BITS)) & GKI_TIMER_WHEEL_MASK);
+        p_tle = p_timer_listq->wheel[slot];
+        p_timer_listq->wheel[slot] = NULL;
+
+        while (p_tle != NULL)
+        {
+            p_next = p_tle->p_next;
+            gki_timer_wheel_place (p_timer_listq, p_tle);
+            p_tle = p_next;
+        }
+    }
+
+    slot  = now & GKI_TIMER_WHEEL_MASK;
+    p_tle = p_timer_listq->wheel[slot];
+    p_timer_listq->wheel[slot] = NULL;
+
+    while (p_tle != NULL)
+    {
+        p_next = p_tle->p_next;
+        gki_timer_wheel_expire (p_timer_listq, p_tle);
+        p_timer_listq->num_pending--;
+        p_tle = p_next;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         GKI_update_timer_list
+**
+** Description      This function is called by the applications when they
+**                  want to update a timer list. This should be at every
+**                  timer list unit tick, e.g. once per sec, once per minute etc.
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**                  num_units_since_last_update - (input) number of units since the last update
+**                                  (allows for variable unit update)
+**
+**      NOTE: The following timer list update routines should not be used for exact time
+**            critical purposes.  The timer tasks should be used when exact timing is needed.
+**
+** Returns          the number of timers that have expired
+**
+*******************************************************************************/
+UINT16 GKI_update_timer_list (TIMER_LIST_Q *p_timer_listq, INT32 num_units_since_last_update)
+{
+    TIMER_LIST_ENT  *p_tle;
+    UINT16           num_time_out = 0;
+
+    if (num_units_since_last_update > 0)
+    {
+        if (p_timer_listq->num_pending == 0)
+        {
+            /* nothing to expire, just move the time forward */
+            p_timer_listq->cur_time += (UINT32) num_units_since_last_update;
+        }
+        else
+        {
+            while ((num_units_since_last_update > 0) && (p_timer_listq->num_pending))
+            {
+                gki_timer_wheel_tick (p_timer_listq);
+                num_units_since_last_update--;
+            }
+
+            if (num_units_since_last_update > 0)
+                p_timer_listq->cur_time += (UINT32) num_units_since_last_update;
+        }
+    }
+
+    for (p_tle = p_timer_listq->p_first; p_tle != NULL; p_tle = p_tle->p_next)
+        num_time_out++;
+
+    return (num_time_out);
+}
+
+/*******************************************************************************
+**
+** Function         GKI_get_remaining_ticks
+**
+** Description      This function is called by an application to get remaining
+**                  ticks to expire
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**                  p_target_tle    - (input) pointer to a timer list queue entry
+**
+** Returns          0 if timer is not used or timer is not in the list
+**                  remaining ticks if success
+**
+*******************************************************************************/
+UINT32 GKI_get_remaining_ticks (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_target_tle)
+{
+    if (!p_target_tle->in_use)
+    {
+        BT_ERROR_TRACE_0(TRACE_LAYER_GKI, "GKI_get_remaining_ticks: timer entry is not active");
+        return (0);
+    }
+
+    if (p_target_tle->wheel_slot == GKI_TIMER_WHEEL_EXPIRED)
+        return (0);
+
+    return (p_target_tle->expires - p_timer_listq->cur_time);
+}
+
+/*******************************************************************************
+**
+** Function         GKI_add_to_timer_list
+**
+** Description      This function is called by an application to add a timer
+**                  entry to a timer list.
+**
+**                  Note: A timer value of '0' will effectively insert an already
+**                      expired event.  Negative tick values will be ignored.
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**                  p_tle           - (input) pointer to a timer list queue entry
+**
+** Returns          void
+**
+*******************************************************************************/
+void GKI_add_to_timer_list (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_tle)
+{
+    if (p_tle == NULL || p_timer_listq == NULL) {
+        GKI_TRACE_3("%s: invalid argument %x, %x****************************<<", __func__, p_timer_listq, p_tle);
+        return;
+    }
+
+    /* Only process valid tick values */
+    if (p_tle->ticks >= 0)
+    {
+        if (p_tle->ticks == 0)
+        {
+            gki_timer_wheel_expire (p_timer_listq, p_tle);
+        }
+        else
+        {
+            p_tle->expires = p_timer_listq->cur_time + (UINT32) p_tle->ticks;
+            gki_timer_wheel_place (p_timer_listq, p_tle);
+            p_timer_listq->num_pending++;
+        }
+
+        p_tle->in_use = TRUE;
+
+        gki_timer_queue_add (p_timer_listq);
+    }
+
+    return;
+}
+
+
+/*******************************************************************************
+**
+** Function         GKI_remove_from_timer_list
+**
+** Description      This function is called by an application to remove a timer
+**                  entry from a timer list.
+**
+** Parameters       p_timer_listq   - (input) pointer to the timer list queue object
+**                  p_tle           - (input) pointer to a timer list queue entry
+**
+** Returns          void
+**
+*******************************************************************************/
+void GKI_remove_from_timer_list (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p_tle)
+{
+    /* Verify that the entry is valid */
+    if (p_tle == NULL || p_tle->in_use == FALSE || GKI_IS_TIMER_LIST_EMPTY (p_timer_listq))
+    {
+        return;
+    }
+
+    if (p_tle->wheel_slot == GKI_TIMER_WHEEL_EXPIRED)
+    {
+        if (p_tle->p_prev != NULL)
+            p_tle->p_prev->p_next = p_tle->p_next;
+        else
+            p_timer_listq->p_first = p_tle->p_next;
+
+        if (p_tle->p_next != NULL)
+            p_tle->p_next->p_prev = p_tle->p_prev;
+        else
+            p_timer_listq->p_last = p_tle->p_prev;
+    }
+    else
+    {
+        if (p_tle->p_prev != NULL)
+            p_tle->p_prev->p_next = p_tle->p_next;
+        else
+            p_timer_listq->wheel[p_tle->wheel_slot] = p_tle->p_next;
+
+        if (p_tle->p_next != NULL)
+            p_tle->p_next->p_prev = p_tle->p_prev;
+
+        p_timer_listq->num_pending--;
+    }
+
+    p_tle->p_next = p_tle->p_prev = NULL;
+    p_tle->ticks = GKI_UNUSED_LIST_ENTRY;
+    p_tle->in_use = FALSE;
+
+    /* if timer queue is empty */
+    if (GKI_IS_TIMER_LIST_EMPTY (p_timer_listq))
+    {
+        gki_timer_queue_remove (p_timer_listq);
+    }
+
+    return;
+}
+
+#else   /* GKI_TIMER_WHEEL */
+
 /*******************************************************************************
 **
 ** Function         GKI_update_timer_list
@@ -984,6 +1355,8 @@ void GKI_remove_from_timer_list (TIMER_LIST_Q *p_timer_listq, TIMER_LIST_ENT  *p
 }
 
 
+#endif  /* GKI_TIMER_WHEEL */
+
 /*******************************************************************************
 **
 ** Function         gki_adjust_timer_count
@@ -1010,6 +1383,11 @@ void gki_adjust_timer_count (INT32 ticks)
         {
             gki_cb.com.OSNumOrigTicks = (gki_cb.com.OSNumOrigTicks - gki_cb.com.OSTicksTilExp) + ticks;
             gki_cb.com.OSTicksTilExp = ticks;
+
+#if (GKI_TICKLESS == TRUE)
+            /* timer loop may be sleeping on a later deadline */
+            gki_tickless_rearm ();
+#endif
         }
     }
 
@@ -40,6 +40,10 @@ typedef struct
     pthread_mutex_t     gki_timer_mutex;
     pthread_cond_t      gki_timer_cond;
     int                 gki_timer_wake_lock_on;
+#if (GKI_TICKLESS == TRUE)
+    UINT64              tick_base_ms;       /* monotonic time (ms) GKI_timer_update() has accounted for */
+    UINT32              tick_rearm_gen;     /* bumped whenever an earlier timer deadline is set */
+#endif
 #if (GKI_DEBUG == TRUE)
     pthread_mutex_t     GKI_trace_mutex;
 #endif
@@ -71,6 +71,7 @@ static pthread_cond_t   gki_timer_update_cond;
 */
 #ifdef NO_GKI_RUN_RETURN
 static pthread_t            timer_thread_id = 0;
+static volatile int         shutdown_timer = 0;
 #endif
 
 
@@ -90,6 +91,10 @@ typedef struct
 } gki_pthread_info_t;
 gki_pthread_info_t gki_pthread_info[GKI_MAX_TASKS];
 
+#if (GKI_TICKLESS == TRUE)
+static UINT64 gki_tickless_now_ms(void);
+#endif
+
 /*******************************************************************************
 **
 ** Function         gki_task_entry
@@ -174,6 +179,9 @@ void GKI_init(void)
     p_os->no_timer_suspend = GKI_TIMER_TICK_RUN_COND;
     pthread_mutex_init(&p_os->gki_timer_mutex, NULL);
     pthread_cond_init(&p_os->gki_timer_cond, NULL);
+#if (GKI_TICKLESS == TRUE)
+    p_os->tick_base_ms = gki_tickless_now_ms();
+#endif
 }
 
 
@@ -326,6 +334,11 @@ void GKI_shutdown(void)
     int result;
 #endif
 
+#if (GKI_POOL_STATS == TRUE)
+    /* log the buffer pool usage of this session, used for sizing the pools in gki_target.h */
+    GKI_dump_pool_stats();
+#endif
+
     /* release threads and set as TASK_DEAD. going from low to high priority fixes
      * GKI_exception problem due to btu->hci sleep request events  */
     for (task_id = GKI_MAX_TASKS; task_id > 0; task_id--)
@@ -382,6 +395,10 @@ void GKI_shutdown(void)
     *p_run_cond = GKI_TIMER_TICK_EXIT_COND;
     if (oldCOnd == GKI_TIMER_TICK_STOP_COND)
         pthread_cond_signal( &gki_cb.os.gki_timer_cond );
+#if (GKI_TICKLESS == TRUE)
+    else
+        gki_tickless_rearm();   /* timer loop may be sleeping until a far deadline */
+#endif
 
 }
 
@@ -432,6 +449,149 @@ void gki_system_tick_start_stop_cback(BOOLEAN start)
 }
 
 
+#if (GKI_TICKLESS == TRUE)
+/*******************************************************************************
+**
+** Function         gki_tickless_now_ms
+**
+** Description      Read the monotonic clock
+**
+** Returns          current monotonic time in milliseconds
+**
+*******************************************************************************/
+static UINT64 gki_tickless_now_ms(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((UINT64) now.tv_sec * 1000) + (now.tv_nsec / NANOSEC_PER_MILLISEC);
+}
+
+/*******************************************************************************
+**
+** Function         gki_tickless_sync
+**
+** Description      Call GKI_timer_update() with the number of whole ticks that
+**                  have elapsed on the monotonic clock since the last update.
+**                  While the system tick is stopped no timer is running, so
+**                  the reference point is only moved forward.
+**
+**                  Called by the timer loop when it wakes up, and by
+**                  GKI_start_timer()/GKI_get_tick_count() so that new timers
+**                  and time stamps are relative to the current time.
+**
+** Returns          void
+**
+*******************************************************************************/
+void gki_tickless_sync(void)
+{
+    tGKI_OS *p_os = &gki_cb.os;
+    UINT64  now_ms;
+    INT32   ticks;
+
+    GKI_disable();
+
+    now_ms = gki_tickless_now_ms();
+    if (p_os->no_timer_suspend != GKI_TIMER_TICK_RUN_COND)
+    {
+        p_os->tick_base_ms = now_ms;
+    }
+    else if (now_ms - p_os->tick_base_ms >= LINUX_SEC)
+    {
+        ticks = (INT32) ((now_ms - p_os->tick_base_ms) / LINUX_SEC);
+
+        /* keep the remainder so that ticks do not drift */
+        p_os->tick_base_ms += (UINT64) ticks * LINUX_SEC;
+        GKI_timer_update(ticks);
+    }
+
+    GKI_enable();
+}
+
+/*******************************************************************************
+**
+** Function         gki_tickless_rearm
+**
+** Description      Wake up the timer loop so that it recomputes its deadline.
+**                  Called when a timer that expires earlier than the current
+**                  deadline is started.
+**
+** Returns          void
+**
+*******************************************************************************/
+void gki_tickless_rearm(void)
+{
+    tGKI_OS *p_os = &gki_cb.os;
+
+    pthread_mutex_lock(&p_os->gki_timer_mutex);
+    p_os->tick_rearm_gen++;
+    pthread_cond_signal(&p_os->gki_timer_cond);
+    pthread_mutex_unlock(&p_os->gki_timer_mutex);
+}
+
+/*******************************************************************************
+**
+** Function         gki_tickless_wait
+**
+** Description      Sleep until the next task timer expiration (or the delayed
+**                  system tick stop), then update the GKI timers. Returns early
+**                  if gki_tickless_rearm() is called or the run condition
+**                  changes.
+**
+**                  NOTE: gki_timer_mutex is never held while GKI_disable() is
+**                  taken here, as gki_adjust_timer_count() takes them in the
+**                  opposite order.
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_tickless_wait(void)
+{
+    tGKI_OS         *p_os = &gki_cb.os;
+    struct timespec abstime;
+    UINT64          deadline_ms;
+    UINT32          rearm_gen;
+    INT32           ticks = 0;
+
+    GKI_disable();
+
+    if (gki_cb.com.OSTicksTilExp > 0)
+        ticks = gki_cb.com.OSTicksTilExp;
+    else if (gki_cb.com.OSNumOrigTicks != 0)
+        ticks = 1;  /* expiration pending but not yet processed */
+
+#if (defined(GKI_DELAY_STOP_SYS_TICK) && (GKI_DELAY_STOP_SYS_TICK > 0))
+    if ((gki_cb.com.OSTicksTilStop > 0) && ((ticks == 0) || ((INT32) gki_cb.com.OSTicksTilStop < ticks)))
+        ticks = (INT32) gki_cb.com.OSTicksTilStop;
+#endif
+
+    deadline_ms = p_os->tick_base_ms + (UINT64) ticks * LINUX_SEC;
+    rearm_gen   = p_os->tick_rearm_gen;
+
+    GKI_enable();
+
+    pthread_mutex_lock(&p_os->gki_timer_mutex);
+    if ((rearm_gen == p_os->tick_rearm_gen) && (p_os->no_timer_suspend == GKI_TIMER_TICK_RUN_COND))
+    {
+        if (ticks > 0)
+        {
+            abstime.tv_sec  = deadline_ms / 1000;
+            abstime.tv_nsec = (deadline_ms % 1000) * NANOSEC_PER_MILLISEC;
+            pthread_cond_timedwait_monotonic(&p_os->gki_timer_cond, &p_os->gki_timer_mutex, &abstime);
+        }
+        else
+        {
+            /* no timer is running, sleep until one is started */
+            pthread_cond_wait(&p_os->gki_timer_cond, &p_os->gki_timer_mutex);
+        }
+    }
+    pthread_mutex_unlock(&p_os->gki_timer_mutex);
+
+    if (p_os->no_timer_suspend == GKI_TIMER_TICK_RUN_COND)
+        gki_tickless_sync();
+}
+#endif
+
 /*******************************************************************************
 **
 ** Function         timer_thread
@@ -447,12 +607,31 @@ void gki_system_tick_start_stop_cback(BOOLEAN start)
 void timer_thread(signed long id)
 {
     GKI_TRACE_1("%s enter", __func__);
+#if (GKI_TICKLESS == TRUE)
+    volatile int * p_run_cond = &gki_cb.os.no_timer_suspend;
+#else
     struct timespec delay;
     int timeout = 1000;  /* 10  ms per system tick  */
     int err;
+#endif
 
     while(!shutdown_timer)
     {
+#if (GKI_TICKLESS == TRUE)
+        if (GKI_TIMER_TICK_RUN_COND == *p_run_cond)
+        {
+            gki_tickless_wait();
+        }
+        else
+        {
+            /* gki_tickless_wait() returns at once while the tick is stopped,
+             * block here until it is restarted or GKI shuts down */
+            pthread_mutex_lock( &gki_cb.os.gki_timer_mutex );
+            while ((GKI_TIMER_TICK_STOP_COND == *p_run_cond) && !shutdown_timer)
+                pthread_cond_wait( &gki_cb.os.gki_timer_cond, &gki_cb.os.gki_timer_mutex );
+            pthread_mutex_unlock( &gki_cb.os.gki_timer_mutex );
+        }
+#else
         delay.tv_sec = timeout / 1000;
         delay.tv_nsec = 1000 * 1000 * (timeout%1000);
 
@@ -464,6 +643,7 @@ void timer_thread(signed long id)
         } while (err < 0 && errno ==EINTR);
 
         GKI_timer_update(1);
+#endif
     }
     GKI_TRACE_1("%s exit", __func__);
     pthread_exit(NULL);
@@ -488,8 +668,10 @@ void timer_thread(signed long id)
 void GKI_run (void *p_task_id)
 {
     GKI_TRACE_1("%s enter", __func__);
+#if !defined(NO_GKI_RUN_RETURN) && (GKI_TICKLESS != TRUE)
     struct timespec delay;
     int err = 0;
+#endif
     volatile int * p_run_cond = &gki_cb.os.no_timer_suspend;
 
 #ifndef GKI_NO_TICK_STOP
@@ -519,6 +701,11 @@ void GKI_run (void *p_task_id)
     GKI_TRACE_2("GKI_run, run_cond(%x)=%d ", p_run_cond, *p_run_cond);
     for (;GKI_TIMER_TICK_EXIT_COND != *p_run_cond;)
     {
+#if (GKI_TICKLESS == TRUE)
+        /* sleep until the next timer deadline instead of every tick */
+        while (GKI_TIMER_TICK_RUN_COND == *p_run_cond)
+            gki_tickless_wait();
+#else
         do
         {
             /* adjust hear bit tick in btld by changning TICKS_PER_SEC!!!!! this formula works only for
@@ -541,6 +728,7 @@ void GKI_run (void *p_task_id)
             GKI_timer_update( 1 );
             /* BT_TRACE_2( TRACE_LAYER_HCI, TRACE_TYPE_DEBUG, "update: tv_sec: %d, tv_nsec: %d", delay.tv_sec, delay.tv_nsec ); */
         } while ( GKI_TIMER_TICK_RUN_COND == *p_run_cond);
+#endif
 
         /* currently on reason to exit above loop is no_timer_suspend == GKI_TIMER_TICK_STOP_COND
          * block timer main thread till re-armed by  */
@@ -695,13 +883,13 @@ UINT16 GKI_wait (UINT16 flag, UINT32 timeout)
          should NOT be lost! */
         // we are waking up after waiting for some events, so refresh variables
         // no need to call GKI_disable() here as we know that we will have some events as we've been waking up after condition pending or timeout
-        if (gki_cb.com.OSTaskQFirst[rtask][0])
+        if (GKI_MBOX_HAS_MSG(rtask, 0))
             gki_cb.com.OSWaitEvt[rtask] |= TASK_MBOX_0_EVT_MASK;
-        if (gki_cb.com.OSTaskQFirst[rtask][1])
+        if (GKI_MBOX_HAS_MSG(rtask, 1))
             gki_cb.com.OSWaitEvt[rtask] |= TASK_MBOX_1_EVT_MASK;
-        if (gki_cb.com.OSTaskQFirst[rtask][2])
+        if (GKI_MBOX_HAS_MSG(rtask, 2))
             gki_cb.com.OSWaitEvt[rtask] |= TASK_MBOX_2_EVT_MASK;
-        if (gki_cb.com.OSTaskQFirst[rtask][3])
+        if (GKI_MBOX_HAS_MSG(rtask, 3))
             gki_cb.com.OSWaitEvt[rtask] |= TASK_MBOX_3_EVT_MASK;
 
         if (gki_cb.com.OSRdyTbl[rtask] == TASK_DEAD)
@@ -149,6 +149,11 @@
 #define USERIAL_NFC_PORT                        (USERIAL_PORT_6)
 #endif
 
+/* Number of bytes read from the serial port at a time by the HAL task */
+#ifndef NFC_HAL_RX_BULK_SIZE
+#define NFC_HAL_RX_BULK_SIZE                    (NCI_MSG_HDR_SIZE + 255 + 1)
+#endif
+
 /* Restore NFCC baud rate to default on shutdown if baud rate was updated */
 #ifndef NFC_HAL_RESTORE_BAUD_ON_SHUTDOWN
 #define NFC_HAL_RESTORE_BAUD_ON_SHUTDOWN        TRUE
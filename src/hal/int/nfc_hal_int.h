@@ -449,6 +449,7 @@ void   nfc_hal_send_nci_msg_to_nfc_task (NFC_HDR * p_msg);
 
 /* nfc_hal_nci.c */
 BOOLEAN nfc_hal_nci_receive_msg (UINT8 byte);
+UINT16  nfc_hal_nci_receive_bulk (UINT8 *p_data, UINT16 len, BOOLEAN *p_msg_received);
 BOOLEAN nfc_hal_nci_preproc_rx_nci_msg (NFC_HDR *p_msg);
 NFC_HDR* nfc_hal_nci_postproc_rx_nci_msg (void);
 void    nfc_hal_nci_assemble_nci_msg (void);
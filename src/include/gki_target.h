@@ -137,6 +137,18 @@
 #define GKI_DELAY_STOP_SYS_TICK     10
 #endif
 
+/* TRUE if the GKI timer loop sleeps until the next timer expiration instead of
+   waking up on every system tick (tickless mode). */
+#ifndef GKI_TICKLESS
+#define GKI_TICKLESS                TRUE
+#endif
+
+/* TRUE if timer list queues are kept in a hierarchical timer wheel (constant
+   time add/remove) instead of a delta-encoded sorted list. */
+#ifndef GKI_TIMER_WHEEL
+#define GKI_TIMER_WHEEL             TRUE
+#endif
+
 /******************************************************************************
 **
 ** Buffer configuration
@@ -148,6 +160,25 @@
 #define GKI_USE_DYNAMIC_BUFFERS     FALSE
 #endif
 
+/* TRUE if the buffer pool free queues are lock-free stacks, so that
+   GKI_getbuf()/GKI_freebuf() do not take the GKI mutex. */
+#ifndef GKI_LOCK_FREE_POOLS
+#define GKI_LOCK_FREE_POOLS         TRUE
+#endif
+
+/* TRUE if the task mailboxes are lock-free multi-producer/single-consumer
+   queues, so that GKI_send_msg() does not take the GKI mutex and only sends
+   a mailbox event when the mailbox was idle. */
+#ifndef GKI_LOCK_FREE_MBOX
+#define GKI_LOCK_FREE_MBOX          TRUE
+#endif
+
+/* TRUE to keep per buffer pool allocation statistics (see GKI_get_pool_stats()).
+   They are available in release builds and are logged at GKI_shutdown(). */
+#ifndef GKI_POOL_STATS
+#define GKI_POOL_STATS              TRUE
+#endif
+
 /* The size of the buffers in pool 0. */
 #ifndef GKI_BUF0_SIZE
 #define GKI_BUF0_SIZE               64
@@ -298,6 +298,11 @@
 #define RW_T2T_SEC_SEL_TOUT_RESP    10
 #endif
 
+/* Max blocks read with one T2T FAST_READ command; set to 4 or less to only use READ */
+#ifndef RW_T2T_FAST_READ_MAX_BLOCKS
+#define RW_T2T_FAST_READ_MAX_BLOCKS 60
+#endif
+
 /* RW Type 3 Tag timeout for each API call, in ms */
 #ifndef RW_T3T_TOUT_RESP
 #define RW_T3T_TOUT_RESP            100         /* NFC-Android will use 100 instead of 75 for T3t presence-check */
@@ -330,6 +335,12 @@
 #define RW_T4T_TOUT_RESP            1000
 #endif
 
+/* Max bytes read with one T4T ReadBinary using extended Le, if MLe of tag allows it.
+** The response is reassembled into a GKI buffer, so it must fit GKI_MAX_BUF_SIZE */
+#ifndef RW_T4T_MAX_EXT_READ_SIZE
+#define RW_T4T_MAX_EXT_READ_SIZE    2048
+#endif
+
 /* CE Type 4 Tag timeout for update file, in ms */
 #ifndef CE_T4T_TOUT_UPDATE
 #define CE_T4T_TOUT_UPDATE          1000
@@ -595,6 +606,18 @@
 #define NFA_NDEF_MAX_HANDLERS       8
 #endif
 
+/* Number of recently read NDEF messages kept by NFA RW, keyed by tag UID and a change    */
+/* indicator taken during NDEF detection (0 to disable). A rewrite keeping the NDEF length */
+/* and the bytes covered by the indicator (e.g. T4T NLEN only) is not noticed.             */
+#ifndef NFA_RW_NDEF_CACHE_SIZE
+#define NFA_RW_NDEF_CACHE_SIZE      0
+#endif
+
+/* Max size of an NDEF message kept in the NFA RW NDEF cache */
+#ifndef NFA_RW_NDEF_CACHE_MAX_LEN
+#define NFA_RW_NDEF_CACHE_MAX_LEN   1024
+#endif
+
 /* Maximum number of listen entries configured/registered with NFA_CeConfigureUiccListenTech, */
 /* NFA_CeRegisterFelicaSystemCodeOnDH, or NFA_CeRegisterT4tAidOnDH                            */
 #ifndef NFA_CE_LISTEN_INFO_MAX
@@ -690,6 +713,10 @@
 #ifndef HAL_WRITE
 #define HAL_WRITE(p)    {nfc_cb.p_hal->write(p->len, (UINT8 *)(p+1) + p->offset); GKI_freebuf(p);}
 
+/* The HAL copies the data in write(), so a fragment of a bigger buffer can be
+** passed to it directly. Not defined if HAL_WRITE is overridden. */
+#define HAL_WRITE_FRAGMENT(len, p_frag) nfc_cb.p_hal->write(len, p_frag)
+
 
 
 #endif /* HAL_WRITE */
@@ -274,6 +274,21 @@ typedef UINT8 tNFA_RW_NDEF_ST;
 #define NFA_RW_FL_API_BUSY                      0x10    /* Tag operation is in progress                                             */
 #define NFA_RW_FL_ACTIVATED                     0x20    /* Tag is been activated                                                    */
 
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+#define NFA_RW_MAX_UID_LEN      NCI_NFCID1_MAX_LEN
+
+/* Recently read NDEF message */
+typedef struct
+{
+    tNFC_PROTOCOL   protocol;
+    UINT8           uid_len;                    /* 0 if entry is not used */
+    UINT8           uid[NFA_RW_MAX_UID_LEN];
+    UINT32          chg_ind;                    /* Change indicator of tag when message was read */
+    UINT32          ndef_len;
+    UINT8           *p_ndef;
+} tNFA_RW_NDEF_CACHE;
+#endif
+
 /* NFA RW control block */
 typedef struct
 {
@@ -319,6 +334,14 @@ typedef struct
     UINT8           i93_block_size;
     UINT16          i93_num_block;
     UINT8           i93_uid[I93_UID_BYTE_LEN];
+
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+    /* NDEF read cache, most recently used first */
+    UINT8           uid_len;        /* UID of activated tag, 0 if not cacheable */
+    UINT8           uid[NFA_RW_MAX_UID_LEN];
+    UINT32          ndef_chg_ind;   /* Change indicator from last NDEF detection, 0 if unknown */
+    tNFA_RW_NDEF_CACHE ndef_cache[NFA_RW_NDEF_CACHE_SIZE];
+#endif
 } tNFA_RW_CB;
 extern tNFA_RW_CB nfa_rw_cb;
 
@@ -342,6 +365,9 @@ extern BOOLEAN nfa_rw_handle_event (BT_HDR *p_msg);
 
 extern void    nfa_rw_free_ndef_rx_buf (void);
 extern void    nfa_rw_sys_disable (void);
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+extern void    nfa_rw_ndef_cache_free (void);
+#endif
 
 #endif /* NFA_DM_INT_H */
 
@@ -100,6 +100,266 @@ static void nfa_rw_store_ndef_rx_buf (tRW_DATA *p_rw_data)
     p_rw_data->data.p_data = NULL;
 }
 
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+/*******************************************************************************
+**
+** Function         nfa_rw_ndef_cache_set_uid
+**
+** Description      Store UID of activated tag for NDEF cache lookups
+**
+** Returns          Nothing
+**
+*******************************************************************************/
+static void nfa_rw_ndef_cache_set_uid (tNFC_ACTIVATE_DEVT *p_activate_params)
+{
+    tNFC_RF_TECH_PARAMS *p_tech = &p_activate_params->rf_tech_param;
+    UINT8               *p_uid  = NULL;
+
+    nfa_rw_cb.uid_len      = 0;
+    nfa_rw_cb.ndef_chg_ind = 0;
+
+    switch (p_tech->mode)
+    {
+    case NFC_DISCOVERY_TYPE_POLL_A:
+    case NFC_DISCOVERY_TYPE_POLL_A_ACTIVE:
+        /* Random single size UID (first byte 08h) is not a tag identity */
+        if (  (p_tech->param.pa.nfcid1_len == 4)
+            &&(p_tech->param.pa.nfcid1[0] == 0x08)  )
+            return;
+        p_uid             = p_tech->param.pa.nfcid1;
+        nfa_rw_cb.uid_len = p_tech->param.pa.nfcid1_len;
+        break;
+
+    case NFC_DISCOVERY_TYPE_POLL_B:
+        p_uid             = p_tech->param.pb.nfcid0;
+        nfa_rw_cb.uid_len = NFC_NFCID0_MAX_LEN;
+        break;
+
+    case NFC_DISCOVERY_TYPE_POLL_F:
+    case NFC_DISCOVERY_TYPE_POLL_F_ACTIVE:
+        p_uid             = p_tech->param.pf.nfcid2;
+        nfa_rw_cb.uid_len = NFC_NFCID2_LEN;
+        break;
+
+    case NFC_DISCOVERY_TYPE_POLL_ISO15693:
+        p_uid             = p_tech->param.pi93.uid;
+        nfa_rw_cb.uid_len = NFC_ISO15693_UID_LEN;
+        break;
+
+    default:
+        return;
+    }
+
+    if (nfa_rw_cb.uid_len > NFA_RW_MAX_UID_LEN)
+        nfa_rw_cb.uid_len = 0;
+    else
+        memcpy (nfa_rw_cb.uid, p_uid, nfa_rw_cb.uid_len);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_rw_ndef_cache_find
+**
+** Description      Find NDEF cache entry of activated tag
+**
+** Returns          Index of entry, or NFA_RW_NDEF_CACHE_SIZE if not found
+**
+*******************************************************************************/
+static UINT8 nfa_rw_ndef_cache_find (void)
+{
+    tNFA_RW_NDEF_CACHE *p_entry = nfa_rw_cb.ndef_cache;
+    UINT8              xx;
+
+    for (xx = 0; xx < NFA_RW_NDEF_CACHE_SIZE; xx++, p_entry++)
+    {
+        if (  (nfa_rw_cb.uid_len != 0)
+            &&(p_entry->uid_len  == nfa_rw_cb.uid_len)
+            &&(p_entry->protocol == nfa_rw_cb.protocol)
+            &&(memcmp (p_entry->uid, nfa_rw_cb.uid, nfa_rw_cb.uid_len) == 0)  )
+            break;
+    }
+    return (xx);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_rw_ndef_cache_move
+**
+** Description      Move NDEF cache entry to the front (most recently used)
+**
+** Returns          Nothing
+**
+*******************************************************************************/
+static void nfa_rw_ndef_cache_move (UINT8 idx)
+{
+    tNFA_RW_NDEF_CACHE entry;
+
+    if (idx > 0)
+    {
+        entry = nfa_rw_cb.ndef_cache[idx];
+        memmove (&nfa_rw_cb.ndef_cache[1], &nfa_rw_cb.ndef_cache[0], idx * sizeof (tNFA_RW_NDEF_CACHE));
+        nfa_rw_cb.ndef_cache[0] = entry;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_rw_ndef_cache_drop
+**
+** Description      Free NDEF cache entry and close the gap it leaves
+**
+** Returns          Nothing
+**
+*******************************************************************************/
+static void nfa_rw_ndef_cache_drop (UINT8 idx)
+{
+    nfa_mem_co_free (nfa_rw_cb.ndef_cache[idx].p_ndef);
+    memmove (&nfa_rw_cb.ndef_cache[idx], &nfa_rw_cb.ndef_cache[idx + 1],
+             (NFA_RW_NDEF_CACHE_SIZE - 1 - idx) * sizeof (tNFA_RW_NDEF_CACHE));
+    memset (&nfa_rw_cb.ndef_cache[NFA_RW_NDEF_CACHE_SIZE - 1], 0, sizeof (tNFA_RW_NDEF_CACHE));
+}
+
+/*******************************************************************************
+**
+** Function         nfa_rw_ndef_cache_read
+**
+** Description      Copy cached NDEF message of activated tag into NDEF rx
+**                  buffer, if the tag has not changed since it was cached
+**
+** Returns          TRUE if NDEF message was copied
+**
+*******************************************************************************/
+static BOOLEAN nfa_rw_ndef_cache_read (void)
+{
+    UINT8              idx = nfa_rw_ndef_cache_find ();
+    tNFA_RW_NDEF_CACHE *p_entry;
+
+    if (idx == NFA_RW_NDEF_CACHE_SIZE)
+        return FALSE;
+
+    p_entry = &nfa_rw_cb.ndef_cache[idx];
+
+    if (  (nfa_rw_cb.ndef_chg_ind == 0)
+        ||(p_entry->chg_ind  != nfa_rw_cb.ndef_chg_ind)
+        ||(p_entry->ndef_len != nfa_rw_cb.ndef_cur_size)  )
+    {
+        /* Tag has changed since its NDEF message was cached */
+        nfa_rw_ndef_cache_drop (idx);
+        return FALSE;
+    }
+
+    NFA_TRACE_DEBUG1 ("NDEF message read from cache (size=%i)", p_entry->ndef_len);
+
+    memcpy (nfa_rw_cb.p_ndef_buf, p_entry->p_ndef, p_entry->ndef_len);
+    nfa_rw_cb.ndef_rd_offset = p_entry->ndef_len;
+    nfa_rw_ndef_cache_move (idx);
+
+    return TRUE;
+}
+
+/*******************************************************************************
+**
+** Function         nfa_rw_ndef_cache_store
+**
+** Description      Cache NDEF message just read from activated tag
+**
+** Returns          Nothing
+**
+*******************************************************************************/
+static void nfa_rw_ndef_cache_store (void)
+{
+    tNFA_RW_NDEF_CACHE *p_entry;
+    UINT8              *p_ndef, idx;
+
+    if (  (nfa_rw_cb.uid_len == 0)
+        ||(nfa_rw_cb.ndef_chg_ind == 0)
+        ||(nfa_rw_cb.p_ndef_buf == NULL)
+        ||(nfa_rw_cb.ndef_cur_size == 0)
+        ||(nfa_rw_cb.ndef_cur_size > NFA_RW_NDEF_CACHE_MAX_LEN)  )
+        return;
+
+    /* Drop previous message of this tag */
+    if ((idx = nfa_rw_ndef_cache_find ()) < NFA_RW_NDEF_CACHE_SIZE)
+        nfa_rw_ndef_cache_drop (idx);
+
+    if ((p_ndef = (UINT8 *) nfa_mem_co_alloc (nfa_rw_cb.ndef_cur_size)) == NULL)
+        return;
+
+    /* Reuse least recently used entry */
+    p_entry = &nfa_rw_cb.ndef_cache[NFA_RW_NDEF_CACHE_SIZE - 1];
+    if (p_entry->p_ndef)
+        nfa_mem_co_free (p_entry->p_ndef);
+
+    memcpy (p_ndef, nfa_rw_cb.p_ndef_buf, nfa_rw_cb.ndef_cur_size);
+
+    p_entry->protocol = nfa_rw_cb.protocol;
+    p_entry->uid_len  = nfa_rw_cb.uid_len;
+    memcpy (p_entry->uid, nfa_rw_cb.uid, nfa_rw_cb.uid_len);
+    p_entry->chg_ind  = nfa_rw_cb.ndef_chg_ind;
+    p_entry->ndef_len = nfa_rw_cb.ndef_cur_size;
+    p_entry->p_ndef   = p_ndef;
+
+    nfa_rw_ndef_cache_move (NFA_RW_NDEF_CACHE_SIZE - 1);
+}
+
+/*******************************************************************************
+**
+** Function         nfa_rw_ndef_cache_check_op
+**
+** Description      Forget cached NDEF message if operation may modify the tag
+**
+** Returns          Nothing
+**
+*******************************************************************************/
+static void nfa_rw_ndef_cache_check_op (tNFA_RW_OP op)
+{
+    UINT8 idx;
+
+    switch (op)
+    {
+    case NFA_RW_OP_WRITE_NDEF:
+    case NFA_RW_OP_FORMAT_TAG:
+    case NFA_RW_OP_SEND_RAW_FRAME:
+    case NFA_RW_OP_T1T_WRITE:
+    case NFA_RW_OP_T1T_WRITE8:
+    case NFA_RW_OP_T2T_WRITE:
+    case NFA_RW_OP_T3T_WRITE:
+    case NFA_RW_OP_I93_WRITE_SINGLE_BLOCK:
+    case NFA_RW_OP_I93_WRITE_MULTI_BLOCK:
+        if ((idx = nfa_rw_ndef_cache_find ()) < NFA_RW_NDEF_CACHE_SIZE)
+            nfa_rw_ndef_cache_drop (idx);
+
+        /* Nothing read from now on is cached until NDEF is detected again */
+        nfa_rw_cb.ndef_chg_ind = 0;
+        break;
+
+    default:
+        break;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         nfa_rw_ndef_cache_free
+**
+** Description      Free all cached NDEF messages
+**
+** Returns          Nothing
+**
+*******************************************************************************/
+void nfa_rw_ndef_cache_free (void)
+{
+    UINT8 xx;
+
+    for (xx = 0; xx < NFA_RW_NDEF_CACHE_SIZE; xx++)
+    {
+        if (nfa_rw_cb.ndef_cache[xx].p_ndef)
+            nfa_mem_co_free (nfa_rw_cb.ndef_cache[xx].p_ndef);
+    }
+    memset (nfa_rw_cb.ndef_cache, 0, sizeof (nfa_rw_cb.ndef_cache));
+}
+#endif /* NFA_RW_NDEF_CACHE_SIZE > 0 */
+
 /*******************************************************************************
 **
 ** Function         nfa_rw_send_data_to_upper
@@ -224,6 +484,12 @@ static void nfa_rw_handle_ndef_detect(tRW_EVENT event, tRW_DATA *p_rw_data)
         else
             nfa_rw_cb.flags &= ~NFA_RW_FL_TAG_IS_READONLY;
 
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+        /* Detection is the validating read for the NDEF cache */
+        if (RW_GetNdefChangeInd (&nfa_rw_cb.ndef_chg_ind) != NFC_STATUS_OK)
+            nfa_rw_cb.ndef_chg_ind = 0;
+#endif
+
         /* Determine what operation triggered the NDEF detection procedure */
         if (nfa_rw_cb.cur_op == NFA_RW_OP_READ_NDEF)
         {
@@ -632,6 +898,9 @@ static void nfa_rw_handle_t1t_evt (tRW_EVENT event, tRW_DATA *p_rw_data)
         if (p_rw_data->status == NFC_STATUS_OK)
         {
             /* Process the ndef record */
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+            nfa_rw_ndef_cache_store ();
+#endif
             nfa_dm_ndef_handle_message(NFA_STATUS_OK, nfa_rw_cb.p_ndef_buf, nfa_rw_cb.ndef_cur_size);
         }
         else
@@ -798,6 +1067,9 @@ static void nfa_rw_handle_t2t_evt (tRW_EVENT event, tRW_DATA *p_rw_data)
         if (p_rw_data->status == NFC_STATUS_OK)
         {
             /* Process the ndef record */
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+            nfa_rw_ndef_cache_store ();
+#endif
             nfa_dm_ndef_handle_message(NFA_STATUS_OK, nfa_rw_cb.p_ndef_buf, nfa_rw_cb.ndef_cur_size);
         }
         else
@@ -914,6 +1186,9 @@ static void nfa_rw_handle_t3t_evt (tRW_EVENT event, tRW_DATA *p_rw_data)
         if (p_rw_data->status == NFC_STATUS_OK)
         {
             /* Process the ndef record */
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+            nfa_rw_ndef_cache_store ();
+#endif
             nfa_dm_ndef_handle_message(NFA_STATUS_OK, nfa_rw_cb.p_ndef_buf, nfa_rw_cb.ndef_cur_size);
         }
         else
@@ -1044,6 +1319,9 @@ static void nfa_rw_handle_t4t_evt (tRW_EVENT event, tRW_DATA *p_rw_data)
             nfa_rw_store_ndef_rx_buf (p_rw_data);
 
             /* Process the ndef record */
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+            nfa_rw_ndef_cache_store ();
+#endif
             nfa_dm_ndef_handle_message (NFA_STATUS_OK, nfa_rw_cb.p_ndef_buf, nfa_rw_cb.ndef_cur_size);
 
             /* Free ndef buffer */
@@ -1195,6 +1473,9 @@ static void nfa_rw_handle_i93_evt (tRW_EVENT event, tRW_DATA *p_rw_data)
             nfa_rw_store_ndef_rx_buf (p_rw_data);
 
             /* Process the ndef record */
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+            nfa_rw_ndef_cache_store ();
+#endif
             nfa_dm_ndef_handle_message (NFA_STATUS_OK, nfa_rw_cb.p_ndef_buf, nfa_rw_cb.ndef_cur_size);
 
             /* Free ndef buffer */
@@ -1612,6 +1893,23 @@ static tNFC_STATUS nfa_rw_start_ndef_read(void)
     }
     nfa_rw_cb.ndef_rd_offset = 0;
 
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+    /* Tag unchanged since its NDEF message was cached: no need to read it again */
+    if (nfa_rw_ndef_cache_read ())
+    {
+        nfa_dm_ndef_handle_message(NFA_STATUS_OK, nfa_rw_cb.p_ndef_buf, nfa_rw_cb.ndef_cur_size);
+
+        /* Notify app of read status */
+        conn_evt_data.status = NFA_STATUS_OK;
+        nfa_dm_act_conn_cback_notify(NFA_READ_CPLT_EVT, &conn_evt_data);
+        nfa_rw_free_ndef_rx_buf();
+
+        /* Command complete - perform cleanup */
+        nfa_rw_command_complete();
+        return NFC_STATUS_OK;
+    }
+#endif
+
     switch (protocol)
     {
     case NFC_PROTOCOL_T1T:    /* Type1Tag    - NFC-A */
@@ -2559,6 +2857,9 @@ BOOLEAN nfa_rw_activate_ntf(tNFA_RW_MSG *p_data)
     nfa_rw_cb.skip_dyn_locks = FALSE;
     nfa_rw_cb.ndef_st    = NFA_RW_NDEF_ST_UNKNOWN;
     nfa_rw_cb.tlv_st     = NFA_RW_TLV_DETECT_ST_OP_NOT_STARTED;
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+    nfa_rw_ndef_cache_set_uid (p_activate_params);
+#endif
 
     memset (&tag_params, 0, sizeof(tNFA_TAG_PARAMS));
 
@@ -2777,6 +3078,10 @@ BOOLEAN nfa_rw_handle_op_req (tNFA_RW_MSG *p_data)
     /* Store the current operation */
     nfa_rw_cb.cur_op = p_data->op_req.op;
 
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+    nfa_rw_ndef_cache_check_op (p_data->op_req.op);
+#endif
+
     /* Call appropriate handler for requested operation */
     switch (p_data->op_req.op)
     {
@@ -101,6 +101,11 @@ void nfa_rw_sys_disable (void)
     /* Free scratch buffer if any */
     nfa_rw_free_ndef_rx_buf ();
 
+#if (NFA_RW_NDEF_CACHE_SIZE > 0)
+    /* Free cached NDEF messages */
+    nfa_rw_ndef_cache_free ();
+#endif
+
     /* Free pending command if any */
     if (nfa_rw_cb.p_pending_msg)
     {
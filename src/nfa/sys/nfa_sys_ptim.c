@@ -111,7 +111,7 @@ void nfa_sys_ptim_timer_update (tPTIM_CB *p_cb)
     }
 
     /* if timer list is empty stop periodic GKI timer */
-    if (p_cb->timer_queue.p_first == NULL)
+    if (GKI_IS_TIMER_LIST_EMPTY (&p_cb->timer_queue))
     {
         NFA_TRACE_DEBUG0 ("ptim timer stop");
         GKI_stop_timer (p_cb->timer_id);
@@ -133,7 +133,7 @@ void nfa_sys_ptim_start_timer (tPTIM_CB *p_cb, TIMER_LIST_ENT *p_tle, UINT16 typ
     NFA_TRACE_DEBUG1 ("nfa_sys_ptim_start_timer %08x", p_tle);
 
     /* if timer list is currently empty, start periodic GKI timer */
-    if (p_cb->timer_queue.p_first == NULL)
+    if (GKI_IS_TIMER_LIST_EMPTY (&p_cb->timer_queue))
     {
         NFA_TRACE_DEBUG0 ("ptim timer start");
         p_cb->last_gki_ticks = GKI_get_tick_count ();
@@ -164,7 +164,7 @@ void nfa_sys_ptim_stop_timer (tPTIM_CB *p_cb, TIMER_LIST_ENT *p_tle)
     GKI_remove_from_timer_list (&p_cb->timer_queue, p_tle);
 
     /* if timer list is empty stop periodic GKI timer */
-    if (p_cb->timer_queue.p_first == NULL)
+    if (GKI_IS_TIMER_LIST_EMPTY (&p_cb->timer_queue))
     {
         NFA_TRACE_DEBUG0 ("ptim timer stop");
         GKI_stop_timer (p_cb->timer_id);
@@ -775,6 +775,57 @@ NFC_API extern tNFC_STATUS RW_T3tCheck (UINT8 num_blocks, tT3T_BLOCK_DESC *t3t_b
 *****************************************************************************/
 NFC_API extern tNFC_STATUS RW_T3tUpdate (UINT8 num_blocks, tT3T_BLOCK_DESC *t3t_blocks, UINT8 *p_data);
 
+/*****************************************************************************
+**
+** Function         RW_T3tCheckBatch
+**
+** Description
+**      Read (non-NDEF) contents of any number of blocks, from up to
+**      T3T_MSG_NUM_SERVICES_CHECK_MAX services per command, from a Type3 tag.
+**
+**      The block list is split, in order, into as few CHECK commands as
+**      possible, each with at most max_blocks blocks (0 for
+**      T3T_MSG_NUM_BLOCKS_CHECK_MAX).
+**
+**      The RW_T3T_CHECK_EVT event is used to notify the application of the
+**      block data of each CHECK response. The RW_T3T_CHECK_CPLT_EVT event is
+**      used to notify the application once all blocks have been read.
+**
+**      t3t_blocks must stay valid until RW_T3T_CHECK_CPLT_EVT.
+**
+** Returns
+**      NFC_STATUS_OK: check command started
+**      NFC_STATUS_NO_BUFFERS: unable to allocate a buffer for this operation
+**      NFC_STATUS_FAILED: other error
+**
+*****************************************************************************/
+NFC_API extern tNFC_STATUS RW_T3tCheckBatch (UINT8 max_blocks, UINT16 num_blocks, tT3T_BLOCK_DESC *t3t_blocks);
+
+/*****************************************************************************
+**
+** Function         RW_T3tUpdateBatch
+**
+** Description
+**      Write (non-NDEF) contents of any number of blocks, in up to
+**      T3T_MSG_NUM_SERVICES_UPDATE_MAX services per command, to a Type3 tag.
+**
+**      The block list is split, in order, into as few UPDATE commands as
+**      possible, each with at most max_blocks blocks (0 for
+**      T3T_MSG_NUM_BLOCKS_UPDATE_MAX). p_data holds 16 bytes per block.
+**
+**      The RW_T3T_UPDATE_CPLT_EVT event is used to notify the application
+**      once all blocks have been written.
+**
+**      t3t_blocks and p_data must stay valid until RW_T3T_UPDATE_CPLT_EVT.
+**
+** Returns
+**      NFC_STATUS_OK: update command started
+**      NFC_STATUS_NO_BUFFERS: unable to allocate a buffer for this operation
+**      NFC_STATUS_FAILED: other error
+**
+*****************************************************************************/
+NFC_API extern tNFC_STATUS RW_T3tUpdateBatch (UINT8 max_blocks, UINT16 num_blocks, tT3T_BLOCK_DESC *t3t_blocks, UINT8 *p_data);
+
 /*****************************************************************************
 **
 ** Function         RW_T3tSendRawFrame
@@ -1310,6 +1361,21 @@ NFC_API extern tNFC_STATUS RW_I93PresenceCheck (void);
 *******************************************************************************/
 NFC_API extern tNFC_STATUS RW_SendRawFrame (UINT8 *p_raw_data, UINT16 data_len);
 
+/*******************************************************************************
+**
+** Function         RW_GetNdefChangeInd
+**
+** Description      This function returns the change indicator taken by the
+**                  last successful NDEF detection on the activated tag.
+**                  Unchanged UID and change indicator mean the NDEF message
+**                  is very likely unchanged since it was last read.
+**
+** Returns          NFC_STATUS_OK if a change indicator is available
+**                  NFC_STATUS_FAILED otherwise (e.g. Type 1 Tag)
+**
+*******************************************************************************/
+NFC_API extern tNFC_STATUS RW_GetNdefChangeInd (UINT32 *p_chg_ind);
+
 /*******************************************************************************
 **
 ** Function         RW_SetActivatedTagType
@@ -179,6 +179,8 @@
 #define T2T_CMD_READ            0x30    /* read  4 blocks (16 bytes) */
 #define T2T_CMD_WRITE           0xA2    /* write 1 block  (4 bytes)  */
 #define T2T_CMD_SEC_SEL         0xC2    /* Sector select             */
+#define T2T_CMD_GET_VERSION     0x60    /* product version (NTAG, Ultralight EV1) */
+#define T2T_CMD_FAST_READ       0x3A    /* read a range of blocks (NTAG, Ultralight EV1) */
 #define T2T_RSP_ACK			    0xA
 #define T2T_RSP_NACK5		    0x5
 #define T2T_RSP_NACK1           0x1     /* Nack can be either 1    */
@@ -189,6 +191,12 @@
 #define T2T_READ_DATA_LEN       (T2T_BLOCK_LEN * T2T_READ_BLOCKS)
 #define T2T_WRITE_DATA_LEN      4
 
+#define T2T_GET_VERSION_RSP_LEN 8
+#define T2T_VERSION_VENDOR_BYTE 1     /* vendor ID in GET_VERSION response */
+#define T2T_VERSION_TYPE_BYTE   2     /* product type in GET_VERSION response */
+#define T2T_VERSION_TYPE_UL     0x03  /* MIFARE Ultralight EV1 */
+#define T2T_VERSION_TYPE_NTAG   0x04  /* NTAG21x, NTAG I2C */
+
 
 /* Type 2 TLV definitions */
 #define T2T_TLV_TYPE_NULL         0     /* May be used for padding. SHALL ignore this */
@@ -324,6 +332,8 @@ typedef UINT8 tT3T_POLL_RC;
 */
 #define T4T_CMD_MIN_HDR_SIZE            4       /* CLA, INS, P1, P2 */
 #define T4T_CMD_MAX_HDR_SIZE            5       /* CLA, INS, P1, P2, Lc */
+#define T4T_CMD_EXT_HDR_SIZE            7       /* CLA, INS, P1, P2, extended Lc */
+#define T4T_EXT_LENGTH_SIZE             3       /* 0x00 and 2 bytes of extended Lc or Le */
 
 #define T4T_VERSION_2_0                 0x20    /* version 2.0 */
 #define T4T_VERSION_1_0                 0x10    /* version 1.0 */
@@ -348,6 +358,7 @@ typedef UINT8 tT3T_POLL_RC;
 
 #define T4T_MAX_LENGTH_LE               0xFF    /* Max number of bytes to be read from file in ReadBinary Command */
 #define T4T_MAX_LENGTH_LC               0xFF    /* Max number of bytes written to NDEF file in UpdateBinary Command */
+#define T4T_EXT_LENGTH_PREFIX           0x00    /* first byte of extended Lc or Le */
 
 #define T4T_RSP_STATUS_WORDS_SIZE       0x02
 
@@ -143,6 +143,7 @@ typedef void (tNFC_PWR_ST_CBACK) (void);
 /* data Reassembly error (in BT_HDR.layer_specific) */
 #define NFC_RAS_TOO_BIG             0x08
 #define NFC_RAS_FRAGMENTED          0x01
+#define NFC_RAS_CONTINUED           0x02    /* payload of a later segment, chained after the first one in rx_q */
 
 /* NCI command buffer contains a VSC (in BT_HDR.layer_specific) */
 #define NFC_WAIT_RSP_VSC            0x01
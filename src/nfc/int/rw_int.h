@@ -211,6 +211,9 @@ typedef struct
 #define RW_T2T_SEGMENT_BYTES                            128
 #define RW_T2T_SEGMENT_SIZE                             16
 
+/* Max data size using a single FAST_READ */
+#define RW_T2T_MAX_DATA_PER_READ                        (NFC_RW_POOL_BUF_SIZE - BT_HDR_SIZE - NCI_DATA_HDR_SIZE)
+
 #define RW_T2T_LOCK_NOT_UPDATED                         0x00    /* Lock not yet set as part of SET TAG RO op                */
 #define RW_T2T_LOCK_UPDATE_INITIATED                    0x01    /* Sent command to set the Lock bytes                       */
 #define RW_T2T_LOCK_UPDATED                             0x02    /* Lock bytes are set                                       */
@@ -274,6 +277,9 @@ typedef UINT8 tRW_T2T_LOCK_STATUS;
 #define RW_T2T_SUBSTATE_WAIT_SET_DYN_LOCK_BITS          0x1B    /* waiting for response to set dynamic lock bits            */
 #define RW_T2T_SUBSTATE_WAIT_SET_ST_LOCK_BITS           0x1C    /* waiting for response to set static lock bits             */
 
+/* Sub states in RW_T2T_STATE_DETECT_TLV state */
+#define RW_T2T_SUBSTATE_WAIT_GET_VERSION                0x1D    /* waiting for GET_VERSION rsp to know if FAST_READ works   */
+
 typedef struct
 {
     UINT16              offset;                             /* Offset of the lock byte in the Tag                       */
@@ -308,6 +314,7 @@ typedef struct
     UINT8               tag_data[T2T_READ_DATA_LEN];        /* T2T Block 4 - 7 data                                         */
     UINT8               ndef_status;                        /* The current status of NDEF Write operation                   */
     UINT16              block_read;                         /* Read block                                                   */
+    UINT16              read_len;                           /* Number of bytes requested by the last READ/FAST_READ         */
     UINT16              block_written;                      /* Written block                                                */
     tT2T_CMD_RSP_INFO   *p_cmd_rsp_info;                    /* Pointer to Command rsp info of last sent command             */
     BT_HDR              *p_cur_cmd_buf;                     /* Copy of current command, for retx/send after sector change   */
@@ -316,6 +323,8 @@ typedef struct
     BOOLEAN             b_read_hdr;                         /* Tag header read from tag                                     */
     BOOLEAN             b_read_data;                        /* Tag data block read from tag                                 */
     BOOLEAN             b_hard_lock;                        /* Hard lock the tag as part of config tag to Read only         */
+    BOOLEAN             b_version_read;                     /* GET_VERSION already sent since activation                    */
+    BOOLEAN             b_fast_read;                        /* Tag supports FAST_READ                                       */
 #if (defined (RW_NDEF_INCLUDED) && (RW_NDEF_INCLUDED == TRUE))
     BOOLEAN             skip_dyn_locks;                     /* Skip reading dynamic lock bytes from the tag                 */
     UINT8               found_tlv;                          /* The Tlv found while searching a particular TLV               */
@@ -376,6 +385,7 @@ typedef struct
 #define RW_T3T_FL_W4_NDEF_DETECT_POLL_RSP       0x08    /* Waiting for POLL response for RW_T3tDetectNDef */
 #define RW_T3T_FL_W4_FMT_FELICA_LITE_POLL_RSP   0x10    /* Waiting for POLL response for RW_T3tFormat */
 #define RW_T3T_FL_W4_SRO_FELICA_LITE_POLL_RSP   0x20    /* Waiting for POLL response for RW_T3tSetReadOnly */
+#define RW_T3T_FL_BATCH                         0x40    /* RW_T3tCheckBatch or RW_T3tUpdateBatch in progress */
 
 typedef struct
 {
@@ -400,6 +410,15 @@ typedef struct
 
     UINT8               peer_nfcid2[NCI_NFCID2_LEN];
     UINT8               cur_poll_rc;            /* RC used in current POLL command */
+    UINT8               mrti_check;             /* MRTI for CHECK command (from PMm) */
+    UINT8               mrti_update;            /* MRTI for UPDATE command (from PMm) */
+
+    tT3T_BLOCK_DESC     *p_batch_blocks;        /* Block list of current batch */
+    UINT8               *p_batch_data;          /* Data to write for RW_T3tUpdateBatch */
+    UINT16              batch_num_blocks;       /* Number of blocks in the batch */
+    UINT16              batch_offset;           /* Index of first block not yet acknowledged */
+    UINT8               batch_max_blocks;       /* Max blocks per command */
+    UINT8               batch_cur_blocks;       /* Number of blocks in current command */
 
     UINT8               flags;                  /* Flags see RW_T3T_FL_* */
 } tRW_T3T_CB;
@@ -415,6 +434,9 @@ typedef struct
 /* Max data size using a single UpdateBinary. 6 bytes are for CLA, INS, P1, P2, Lc */
 #define RW_T4T_MAX_DATA_PER_WRITE          (NFC_RW_POOL_BUF_SIZE - BT_HDR_SIZE - NCI_MSG_OFFSET_SIZE - NCI_DATA_HDR_SIZE - T4T_CMD_MAX_HDR_SIZE)
 
+/* Max data size using a single UpdateBinary with extended Lc (CLA, INS, P1, P2, 3 bytes of Lc) */
+#define RW_T4T_MAX_DATA_PER_EXT_WRITE      (NFC_RW_POOL_BUF_SIZE - BT_HDR_SIZE - NCI_MSG_OFFSET_SIZE - NCI_DATA_HDR_SIZE - T4T_CMD_EXT_HDR_SIZE)
+
 
 
 /* Mandatory NDEF file control */
@@ -462,6 +484,7 @@ typedef struct
 
     UINT16              max_read_size;      /* max reading size per a command   */
     UINT16              max_update_size;    /* max updating size per a command  */
+    UINT16              ext_apdu_len;       /* data size of last ReadBinary/UpdateBinary with extended length, 0 if short */
 
     UINT16              card_size;
     UINT8               card_type;
@@ -538,6 +561,10 @@ typedef struct
 
     UINT8               intl_flags;             /* flags for internal information   */
 
+    UINT8               read_blocks;            /* blocks per read multi block      */
+    UINT8               read_ok_count;          /* reads since read_blocks changed  */
+    UINT8               read_fail_blocks;       /* read_blocks of last failed read  */
+
     UINT8               tlv_detect_state;       /* TLV detecting state              */
     UINT8               tlv_type;               /* currently detected type          */
     UINT16              tlv_length;             /* currently detected length        */
@@ -568,6 +595,8 @@ typedef struct
     tRW_TCB             tcb;
     tRW_CBACK           *p_cback;
     UINT32              cur_retry;          /* Retry count for the current operation */
+    UINT8               i93_read_limit[RW_I93_UNKNOWN_PRODUCT]; /* learned max blocks per I93 read multi block, 0 if unknown */
+    UINT32              ndef_chg_ind;       /* Change indicator taken by the last NDEF detection, 0 if unknown */
 #if (defined (RW_STATS_INCLUDED) && (RW_STATS_INCLUDED == TRUE))
     tRW_STATS           stats;
 #endif  /* RW_STATS_INCLUDED */
@@ -611,13 +640,17 @@ extern void rw_t1t_handle_op_complete (void);
 #if (defined (RW_NDEF_INCLUDED) && (RW_NDEF_INCLUDED == TRUE))
 extern tRW_EVENT rw_t2t_info_to_event (const tT2T_CMD_RSP_INFO *p_info);
 extern void rw_t2t_handle_rsp (UINT8 *p_data);
+extern void rw_t2t_handle_version_rsp (UINT8 *p_data, UINT16 len);
 #else
 #define rw_t2t_info_to_event(p)             t2t_info_to_evt (p)
 #define rw_t2t_handle_rsp(p)
+#define rw_t2t_handle_version_rsp(p, l)
 #endif
 
 extern tNFC_STATUS rw_t2t_sector_change (UINT8 sector);
 extern tNFC_STATUS rw_t2t_read (UINT16 block);
+extern tNFC_STATUS rw_t2t_read_range (UINT16 block, UINT16 end_block);
+extern tNFC_STATUS rw_t2t_get_version (void);
 extern tNFC_STATUS rw_t2t_write (UINT16 block, UINT8 *p_write_data);
 extern void rw_t2t_process_timeout (TIMER_LIST_ENT *p_tle);
 extern tNFC_STATUS rw_t2t_select (void);
@@ -633,6 +666,10 @@ extern void rw_t4t_process_timeout (TIMER_LIST_ENT *p_tle);
 extern tNFC_STATUS rw_i93_select (UINT8 *p_uid);
 extern void rw_i93_process_timeout (TIMER_LIST_ENT *p_tle);
 
+/* Initial value for rw_ndef_chg_ind () */
+#define RW_NDEF_CHG_IND_INIT        0x811C9DC5
+extern UINT32 rw_ndef_chg_ind (UINT32 chg_ind, UINT8 *p_data, UINT16 len);
+
 #if (defined (RW_STATS_INCLUDED) && (RW_STATS_INCLUDED == TRUE))
 /* Internal fcns for statistics (from rw_main.c) */
 void rw_main_reset_stats (void);
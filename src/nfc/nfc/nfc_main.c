@@ -644,7 +644,10 @@ static void nfc_main_hal_data_cback(UINT16 data_len, UINT8   *p_data)
             p_msg->event  = BT_EVT_TO_NFC_NCI;
             p_msg->offset = NFC_RECEIVE_MSGS_OFFSET;
 
-            /* no need to check length, it always less than pool size */
+            /* no need to check length, it always less than pool size.
+             * p_data is only valid during the callback (the HAL is a separate module
+             * which does not share the GKI pools), so this is the single copy of the
+             * packet on the receive path */
             memcpy ((UINT8 *)(p_msg + 1) + p_msg->offset, p_data, p_msg->len);
 
             GKI_send_msg (NFC_TASK, NFC_MBOX_ID, p_msg);
@@ -263,6 +263,28 @@ UINT8 nfc_ncif_send_data (tNFC_CONN_CB *p_cb, BT_HDR *p_data)
             p         = p_data;
             p_data    = (BT_HDR *)GKI_dequeue (&p_cb->tx_q);
         }
+#ifdef HAL_WRITE_FRAGMENT
+        else if (p_data->offset >= NCI_DATA_HDR_SIZE)
+        {
+            /* send the fragment straight out of the original buffer. The NCI data
+             * header goes in the bytes just before the fragment: the headroom of the
+             * buffer for the first fragment, or the end of the fragment which was
+             * already copied by the HAL for the following ones */
+            ps = (UINT8 *)(p_data + 1) + p_data->offset - NCI_DATA_HDR_SIZE;
+            pp = ps;
+            NCI_DATA_PBLD_HDR(pp, pbf, hdr0, ulen);
+
+            if (p_cb->num_buff != NFC_CONN_NO_FC)
+                p_cb->num_buff--;
+
+            HAL_WRITE_FRAGMENT((UINT16)(ulen + NCI_DATA_HDR_SIZE), ps);
+
+            /* adjust the BT_HDR on the old fragment */
+            p_data->len     -= ulen;
+            p_data->offset  += ulen;
+            continue;
+        }
+#endif
         else
         {
             /* the data packet is too big and need to be fragmented
@@ -1682,6 +1704,74 @@ void nfc_data_event (tNFC_CONN_CB * p_cb)
     }
 }
 
+/*******************************************************************************
+**
+** Function         nfc_ncif_ras_complete
+**
+** Description      Join the segments of a reassembled data packet. The first
+**                  segment keeps its NCI header; the later ones are chained
+**                  after it in rx_q with the header stripped. The payloads are
+**                  copied once, into the first segment if it has room, else
+**                  into a buffer of the size of the whole packet.
+**
+** Returns          the reassembled packet (at the end of rx_q)
+**
+*******************************************************************************/
+static BT_HDR *nfc_ncif_ras_complete (tNFC_CONN_CB *p_cb, BT_HDR *p_first)
+{
+    BT_HDR  *p_seg;
+    BT_HDR  *p_next;
+    BT_HDR  *p_dest = p_first;
+    UINT8   *pd;
+    UINT32  total = p_first->len;
+
+    for (p_seg = (BT_HDR *)GKI_getnext (p_first); p_seg; p_seg = (BT_HDR *)GKI_getnext (p_seg))
+        total += p_seg->len;
+
+    if (GKI_get_buf_size (p_first) < (BT_HDR_SIZE + p_first->offset + total))
+    {
+        /* the first segment is too small. get a buffer for the whole packet */
+        p_dest = NULL;
+        if ((BT_HDR_SIZE + p_first->offset + total) <= GKI_MAX_BUF_SIZE)
+            p_dest = (BT_HDR *)GKI_getbuf ((UINT16)(BT_HDR_SIZE + p_first->offset + total));
+
+        if (p_dest)
+        {
+            memcpy (p_dest, p_first, BT_HDR_SIZE);
+            memcpy ((UINT8 *)(p_dest + 1) + p_dest->offset, (UINT8 *)(p_first + 1) + p_first->offset, p_first->len);
+        }
+        else
+        {
+            p_first->layer_specific |= NFC_RAS_TOO_BIG;
+            NFC_TRACE_ERROR1 ("nci_reassemble_msg buffer overrun(%d)!!", total);
+        }
+    }
+
+    /* move the payload of the chained segments to the destination, if any */
+    for (p_seg = (BT_HDR *)GKI_getnext (p_first); p_seg; p_seg = p_next)
+    {
+        p_next = (BT_HDR *)GKI_getnext (p_seg);
+        if (p_dest)
+        {
+            pd = (UINT8 *)(p_dest + 1) + p_dest->offset + p_dest->len;
+            memcpy (pd, (UINT8 *)(p_seg + 1) + p_seg->offset, p_seg->len);
+            p_dest->len += p_seg->len;
+        }
+        GKI_remove_from_queue (&p_cb->rx_q, p_seg);
+        GKI_freebuf (p_seg);
+    }
+
+    if ((p_dest) && (p_dest != p_first))
+    {
+        GKI_remove_from_queue (&p_cb->rx_q, p_first);
+        GKI_freebuf (p_first);
+        GKI_enqueue (&p_cb->rx_q, p_dest);
+        return (p_dest);
+    }
+
+    return (p_first);
+}
+
 /*******************************************************************************
 **
 ** Function         nfc_ncif_proc_data
@@ -1698,12 +1788,11 @@ void nfc_ncif_proc_data (BT_HDR *p_msg)
     UINT8   *pp, cid;
     tNFC_CONN_CB * p_cb;
     UINT8   pbf;
+    BT_HDR  *p_first;
     BT_HDR  *p_last;
     UINT8   *ps, *pd;
     UINT16  size;
-    BT_HDR  *p_max = NULL;
     UINT16  len;
-    UINT16  error_mask = 0;
 
     pp   = (UINT8 *) (p_msg+1) + p_msg->offset;
     NFC_TRACE_DEBUG3 ("nfc_ncif_proc_data 0x%02x%02x%02x", pp[0], pp[1], pp[2]);
@@ -1720,59 +1809,56 @@ void nfc_ncif_proc_data (BT_HDR *p_msg)
             p_last = (BT_HDR *)GKI_getlast (&p_cb->rx_q);
             if (p_last && (p_last->layer_specific & NFC_RAS_FRAGMENTED))
             {
-                /* last data buffer is not last fragment, append this new packet to the last */
-                size = GKI_get_buf_size(p_last);
-                if (size < (BT_HDR_SIZE + p_last->len + p_last->offset + len))
+                /* find the first segment of the packet being reassembled */
+                p_first = p_last;
+                if (p_last->layer_specific & NFC_RAS_CONTINUED)
                 {
-                    /* the current size of p_last is not big enough to hold the new fragment, p_msg */
-                    if (size != GKI_MAX_BUF_SIZE)
-                    {
-                        /* try the biggest GKI pool */
-                        p_max = (BT_HDR *)GKI_getpoolbuf (GKI_MAX_BUF_SIZE_POOL_ID);
-                        if (p_max)
-                        {
-                            /* copy the content of last buffer to the new buffer */
-                            memcpy(p_max, p_last, BT_HDR_SIZE);
-                            pd  = (UINT8 *)(p_max + 1) + p_max->offset;
-                            ps  = (UINT8 *)(p_last + 1) + p_last->offset;
-                            memcpy(pd, ps, p_last->len);
-
-                            /* place the new buffer in the queue instead */
-                            GKI_remove_from_queue (&p_cb->rx_q, p_last);
-                            GKI_freebuf (p_last);
-                            GKI_enqueue (&p_cb->rx_q, p_max);
-                            p_last  = p_max;
-                        }
-                    }
-                    if (p_max == NULL)
-                    {
-                        p_last->layer_specific  |= NFC_RAS_TOO_BIG;
-                        NFC_TRACE_ERROR1 ("nci_reassemble_msg buffer overrun(%d)!!", len);
-                    }
+                    /* packets before it in rx_q are complete */
+                    p_first = (BT_HDR *)GKI_getfirst (&p_cb->rx_q);
+                    while ((p_first->layer_specific & NFC_RAS_FRAGMENTED) == 0)
+                        p_first = (BT_HDR *)GKI_getnext (p_first);
                 }
 
                 ps   = (UINT8 *)(p_msg + 1) + p_msg->offset + NCI_MSG_HDR_SIZE;
                 len  = p_msg->len - NCI_MSG_HDR_SIZE;
-                if ((p_last->layer_specific & NFC_RAS_TOO_BIG) == 0)
+                size = GKI_get_buf_size(p_last);
+
+                if (size >= (BT_HDR_SIZE + p_last->offset + p_last->len + len))
                 {
+                    /* the new segment fits in the last buffer of the chain */
                     pd   = (UINT8 *)(p_last + 1) + p_last->offset + p_last->len;
                     memcpy(pd, ps, len);
                     p_last->len  += len;
-                    /* do not need to update pbf and len in NCI header.
-                     * They are stripped off at NFC_DATA_CEVT and len may exceed 255 */
-                    NFC_TRACE_DEBUG1 ("nfc_ncif_proc_data len:%d", p_last->len);
+                    GKI_freebuf (p_msg);
                 }
-
-                error_mask              = (p_last->layer_specific & NFC_RAS_TOO_BIG);
-                p_last->layer_specific  = (p_msg->layer_specific | error_mask);
-                GKI_freebuf (p_msg);
-#ifdef DISP_NCI
-                if ((p_last->layer_specific & NFC_RAS_FRAGMENTED) == 0)
+                else
                 {
-                    /* this packet was reassembled. display the complete packet */
-                    DISP_NCI ((UINT8 *)(p_last + 1) + p_last->offset, p_last->len, TRUE);
+                    /* chain the new segment instead of copying it into a bigger buffer.
+                     * The chain is joined once the last segment arrives */
+                    p_msg->offset           += NCI_MSG_HDR_SIZE;
+                    p_msg->len               = len;
+                    p_msg->layer_specific    = NFC_RAS_FRAGMENTED | NFC_RAS_CONTINUED;
+                    GKI_enqueue (&p_cb->rx_q, p_msg);
+                    p_last = p_msg;
                 }
+
+                if (pbf == 0)
+                {
+                    /* last segment. do not need to update pbf and len in NCI header.
+                     * They are stripped off at NFC_DATA_CEVT and len may exceed 255 */
+                    if (p_last != p_first)
+                        p_first = nfc_ncif_ras_complete (p_cb, p_first);
+
+                    p_first->layer_specific &= NFC_RAS_TOO_BIG;
+                    NFC_TRACE_DEBUG1 ("nfc_ncif_proc_data len:%d", p_first->len);
+#ifdef DISP_NCI
+                    if (p_first->layer_specific == 0)
+                    {
+                        /* this packet was reassembled. display the complete packet */
+                        DISP_NCI ((UINT8 *)(p_first + 1) + p_first->offset, p_first->len, TRUE);
+                    }
 #endif
+                }
             }
             else
             {
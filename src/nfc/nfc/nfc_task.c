@@ -61,7 +61,7 @@ void nfc_start_timer (TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout)
     BT_HDR *p_msg;
 
     /* if timer list is currently empty, start periodic GKI timer */
-    if (nfc_cb.timer_queue.p_first == NULL)
+    if (GKI_IS_TIMER_LIST_EMPTY (&nfc_cb.timer_queue))
     {
         /* if timer starts on other than NFC task (scritp wrapper) */
         if (GKI_get_taskid () != NFC_TASK)
@@ -139,7 +139,7 @@ void nfc_process_timer_evt (void)
     }
 
     /* if timer list is empty stop periodic GKI timer */
-    if (nfc_cb.timer_queue.p_first == NULL)
+    if (GKI_IS_TIMER_LIST_EMPTY (&nfc_cb.timer_queue))
     {
         GKI_stop_timer (NFC_TIMER_ID);
     }
@@ -159,7 +159,7 @@ void nfc_stop_timer (TIMER_LIST_ENT *p_tle)
     GKI_remove_from_timer_list (&nfc_cb.timer_queue, p_tle);
 
     /* if timer list is empty stop periodic GKI timer */
-    if (nfc_cb.timer_queue.p_first == NULL)
+    if (GKI_IS_TIMER_LIST_EMPTY (&nfc_cb.timer_queue))
     {
         GKI_stop_timer (NFC_TIMER_ID);
     }
@@ -183,7 +183,7 @@ void nfc_start_quick_timer (TIMER_LIST_ENT *p_tle, UINT16 type, UINT32 timeout)
     BT_HDR *p_msg;
 
     /* if timer list is currently empty, start periodic GKI timer */
-    if (nfc_cb.quick_timer_queue.p_first == NULL)
+    if (GKI_IS_TIMER_LIST_EMPTY (&nfc_cb.quick_timer_queue))
     {
         /* if timer starts on other than NFC task (scritp wrapper) */
         if (GKI_get_taskid () != NFC_TASK)
@@ -227,7 +227,7 @@ void nfc_stop_quick_timer (TIMER_LIST_ENT *p_tle)
     GKI_remove_from_timer_list (&nfc_cb.quick_timer_queue, p_tle);
 
     /* if timer list is empty stop periodic GKI timer */
-    if (nfc_cb.quick_timer_queue.p_first == NULL)
+    if (GKI_IS_TIMER_LIST_EMPTY (&nfc_cb.quick_timer_queue))
     {
         GKI_stop_timer (NFC_QUICK_TIMER_ID);
     }
@@ -293,7 +293,7 @@ void nfc_process_quick_timer_evt (void)
     }
 
     /* if timer list is empty stop periodic GKI timer */
-    if (nfc_cb.quick_timer_queue.p_first == NULL)
+    if (GKI_IS_TIMER_LIST_EMPTY (&nfc_cb.quick_timer_queue))
     {
         GKI_stop_timer (NFC_QUICK_TIMER_ID);
     }
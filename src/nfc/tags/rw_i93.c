@@ -38,6 +38,8 @@
 #define RW_I93_TOUT_RESP                        1000    /* Response timeout     */
 #define RW_I93_TOUT_STAY_QUIET                  200     /* stay quiet timeout   */
 #define RW_I93_READ_MULTI_BLOCK_SIZE            128     /* max reading data if read multi block is supported */
+#define RW_I93_READ_MULTI_INC_BLOCKS            4       /* blocks added to read multi block after successes  */
+#define RW_I93_READ_MULTI_INC_AFTER             2       /* successful reads before adding blocks             */
 #define RW_I93_FORMAT_DATA_LEN                  8       /* CC, zero length NDEF, Terminator TLV              */
 #define RW_I93_GET_MULTI_BLOCK_SEC_SIZE         512     /* max getting lock status if get multi block sec is supported */
 
@@ -88,6 +90,7 @@ static char *rw_i93_get_tag_name (UINT8 product_version);
 static void rw_i93_data_cback (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *p_data);
 void rw_i93_handle_error (tNFC_STATUS status);
 tNFC_STATUS rw_i93_send_cmd_get_sys_info (UINT8 *p_uid, UINT8 extra_flag);
+tNFC_STATUS rw_i93_get_next_blocks (UINT16 offset);
 
 /*******************************************************************************
 **
@@ -1384,11 +1387,177 @@ tNFC_STATUS rw_i93_send_cmd_get_multi_block_sec (UINT16 first_block_number,
     }
 }
 
+/*******************************************************************************
+**
+** Function         rw_i93_is_stm_sector_tag
+**
+** Description      Check if tag limits read multi block to one sector
+**
+**                  LRIS64K, M24LR64-R, M24LR04E-R, M24LR16E-R, M24LR64E-R requires
+**                      The max number of blocks is 32 and they are all located in the same sector.
+**                      The sector is 32 blocks of 4 bytes.
+**
+** Returns          TRUE if tag is one of them
+**
+*******************************************************************************/
+static BOOLEAN rw_i93_is_stm_sector_tag (void)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+
+    return (  (p_i93->uid[1] == I93_UID_IC_MFG_CODE_STM)
+            &&(  (p_i93->product_version == RW_I93_STM_LRIS64K)
+               ||(p_i93->product_version == RW_I93_STM_M24LR64_R)
+               ||(p_i93->product_version == RW_I93_STM_M24LR04E_R)
+               ||(p_i93->product_version == RW_I93_STM_M24LR16E_R)
+               ||(p_i93->product_version == RW_I93_STM_M24LR64E_R)  )  );
+}
+
+/*******************************************************************************
+**
+** Function         rw_i93_get_max_read_blocks
+**
+** Description      Get the max number of blocks for read multi block allowed
+**                  by the tag and learned for its product version
+**
+** Returns          number of blocks (at least 1)
+**
+*******************************************************************************/
+static UINT8 rw_i93_get_max_read_blocks (void)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+    UINT16     num_block;
+
+    num_block = RW_I93_READ_MULTI_BLOCK_SIZE / p_i93->block_size;
+
+    if (  (rw_i93_is_stm_sector_tag ())
+        &&(num_block > I93_STM_MAX_BLOCKS_PER_READ)  )
+    {
+        num_block = I93_STM_MAX_BLOCKS_PER_READ;
+    }
+
+    if (  (p_i93->product_version < RW_I93_UNKNOWN_PRODUCT)
+        &&(rw_cb.i93_read_limit[p_i93->product_version])
+        &&(num_block > rw_cb.i93_read_limit[p_i93->product_version])  )
+    {
+        num_block = rw_cb.i93_read_limit[p_i93->product_version];
+    }
+
+    if (num_block == 0)
+        num_block = 1;
+
+    return (UINT8) num_block;
+}
+
+/*******************************************************************************
+**
+** Function         rw_i93_update_read_blocks
+**
+** Description      Adjust number of blocks for read multi block after a read
+**
+**                  Additive increase after RW_I93_READ_MULTI_INC_AFTER
+**                  successful reads, halved on CRC error or timeout.
+**                  If a smaller read succeeds after a failure, the failed
+**                  size is remembered for the product version until the
+**                  stack is restarted.
+**
+** Returns          TRUE if number of blocks is reduced
+**
+*******************************************************************************/
+static BOOLEAN rw_i93_update_read_blocks (BOOLEAN success)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+    UINT8      max_blocks;
+
+    if (success)
+    {
+        if (p_i93->read_fail_blocks)
+        {
+            if (  (p_i93->product_version < RW_I93_UNKNOWN_PRODUCT)
+                &&(  (rw_cb.i93_read_limit[p_i93->product_version] == 0)
+                   ||(rw_cb.i93_read_limit[p_i93->product_version] >= p_i93->read_fail_blocks)  )  )
+            {
+                rw_cb.i93_read_limit[p_i93->product_version] = p_i93->read_fail_blocks - 1;
+
+                RW_TRACE_DEBUG2 ("rw_i93_update_read_blocks (): limit %d blocks for product_version %d",
+                                  p_i93->read_fail_blocks - 1, p_i93->product_version);
+            }
+            p_i93->read_fail_blocks = 0;
+            p_i93->read_ok_count    = 0;
+        }
+        else if (++p_i93->read_ok_count >= RW_I93_READ_MULTI_INC_AFTER)
+        {
+            p_i93->read_ok_count = 0;
+            max_blocks = rw_i93_get_max_read_blocks ();
+
+            if (p_i93->read_blocks < max_blocks)
+            {
+                if (p_i93->read_blocks + RW_I93_READ_MULTI_INC_BLOCKS < max_blocks)
+                    p_i93->read_blocks += RW_I93_READ_MULTI_INC_BLOCKS;
+                else
+                    p_i93->read_blocks = max_blocks;
+            }
+        }
+        return FALSE;
+    }
+    else
+    {
+        if (p_i93->read_blocks <= 1)
+            return FALSE;
+
+        p_i93->read_fail_blocks = p_i93->read_blocks;
+        p_i93->read_blocks     /= 2;
+        p_i93->read_ok_count    = 0;
+
+        RW_TRACE_DEBUG2 ("rw_i93_update_read_blocks (): read %d blocks instead of %d",
+                          p_i93->read_blocks, p_i93->read_fail_blocks);
+        return TRUE;
+    }
+}
+
+/*******************************************************************************
+**
+** Function         rw_i93_retry_smaller_read
+**
+** Description      Retry failed read multi block of NDEF procedure with fewer
+**                  blocks. This is a new command, not counted as a retry.
+**                  If it cannot be sent the procedure fails; the retry
+**                  buffer is released since it no longer holds the failed
+**                  command.
+**
+** Returns          TRUE if the failed read has been handled
+**
+*******************************************************************************/
+static BOOLEAN rw_i93_retry_smaller_read (void)
+{
+    tRW_I93_CB *p_i93 = &rw_cb.tcb.i93;
+
+    if (  (p_i93->sent_cmd == I93_CMD_READ_MULTI_BLOCK)
+        &&(  (p_i93->state == RW_I93_STATE_DETECT_NDEF)
+           ||(p_i93->state == RW_I93_STATE_READ_NDEF)  )
+        &&(rw_i93_update_read_blocks (FALSE))  )
+    {
+        if (rw_i93_get_next_blocks (p_i93->rw_offset) != NFC_STATUS_OK)
+        {
+            if (p_i93->p_retry_cmd)
+            {
+                GKI_freebuf (p_i93->p_retry_cmd);
+                p_i93->p_retry_cmd = NULL;
+            }
+            p_i93->retry_count = 0;
+
+            rw_i93_handle_error (NFC_STATUS_FAILED);
+        }
+        return TRUE;
+    }
+    return FALSE;
+}
+
 /*******************************************************************************
 **
 ** Function         rw_i93_get_next_blocks
 **
 ** Description      Read as many blocks as possible (up to RW_I93_READ_MULTI_BLOCK_SIZE)
+**                  The number of blocks is adapted to errors on the link.
 **
 ** Returns          tNFC_STATUS
 **
@@ -1407,31 +1576,22 @@ tNFC_STATUS rw_i93_get_next_blocks (UINT16 offset)
 
     if (p_i93->intl_flags & RW_I93_FLAG_READ_MULTI_BLOCK)
     {
-        num_block = RW_I93_READ_MULTI_BLOCK_SIZE / p_i93->block_size;
+        /* start from the max and adapt on errors */
+        if (p_i93->read_blocks == 0)
+            p_i93->read_blocks = rw_i93_get_max_read_blocks ();
+
+        num_block = p_i93->read_blocks;
 
         if (num_block + first_block > p_i93->num_block)
             num_block = p_i93->num_block - first_block;
 
-        if (p_i93->uid[1] == I93_UID_IC_MFG_CODE_STM)
+        if (rw_i93_is_stm_sector_tag ())
         {
-            /* LRIS64K, M24LR64-R, M24LR04E-R, M24LR16E-R, M24LR64E-R requires
-            **      The max number of blocks is 32 and they are all located in the same sector.
-            **      The sector is 32 blocks of 4 bytes.
-            */
-            if (  (p_i93->product_version == RW_I93_STM_LRIS64K)
-                ||(p_i93->product_version == RW_I93_STM_M24LR64_R)
-                ||(p_i93->product_version == RW_I93_STM_M24LR04E_R)
-                ||(p_i93->product_version == RW_I93_STM_M24LR16E_R)
-                ||(p_i93->product_version == RW_I93_STM_M24LR64E_R)  )
+            /* all blocks must be located in the same sector */
+            if ((first_block / I93_STM_BLOCKS_PER_SECTOR)
+                != ((first_block + num_block - 1) / I93_STM_BLOCKS_PER_SECTOR))
             {
-                if (num_block > I93_STM_MAX_BLOCKS_PER_READ)
-                    num_block = I93_STM_MAX_BLOCKS_PER_READ;
-
-                if ((first_block / I93_STM_BLOCKS_PER_SECTOR)
-                    != ((first_block + num_block - 1) / I93_STM_BLOCKS_PER_SECTOR))
-                {
-                    num_block = I93_STM_BLOCKS_PER_SECTOR - (first_block % I93_STM_BLOCKS_PER_SECTOR);
-                }
+                num_block = I93_STM_BLOCKS_PER_SECTOR - (first_block % I93_STM_BLOCKS_PER_SECTOR);
             }
         }
 
@@ -1667,6 +1827,15 @@ void rw_i93_sm_detect_ndef (BT_HDR *p_resp)
                     p_i93->tlv_type = *(p + xx);
                     p_i93->ndef_tlv_start_offset = p_i93->rw_offset + xx;
 
+                    if (p_i93->tlv_type == I93_ICODE_TLV_TYPE_NDEF)
+                    {
+                        /* Change indicator from the NDEF TLV up to the end of its first block */
+                        block = p_i93->block_size - (p_i93->ndef_tlv_start_offset % p_i93->block_size);
+                        if (block > length - xx)
+                            block = length - xx;
+                        rw_cb.ndef_chg_ind = rw_ndef_chg_ind (RW_NDEF_CHG_IND_INIT, p + xx, block);
+                    }
+
                     p_i93->tlv_detect_state = RW_I93_TLV_DETECT_STATE_LENGTH_1;
                 }
                 else if (*(p + xx) == I93_ICODE_TLV_TYPE_TERM)
@@ -2998,12 +3167,15 @@ void rw_i93_process_timeout (TIMER_LIST_ENT *p_tle)
             &&(rw_cb.tcb.i93.p_retry_cmd)
             &&(rw_cb.tcb.i93.sent_cmd != I93_CMD_STAY_QUIET))
         {
-            rw_cb.tcb.i93.retry_count++;
-            RW_TRACE_ERROR1 ("rw_i93_process_timeout (): retry_count = %d", rw_cb.tcb.i93.retry_count);
+            if (!rw_i93_retry_smaller_read ())
+            {
+                rw_cb.tcb.i93.retry_count++;
+                RW_TRACE_ERROR1 ("rw_i93_process_timeout (): retry_count = %d", rw_cb.tcb.i93.retry_count);
 
-            p_buf = rw_cb.tcb.i93.p_retry_cmd;
-            rw_cb.tcb.i93.p_retry_cmd = NULL;
-            rw_i93_send_to_lower (p_buf);
+                p_buf = rw_cb.tcb.i93.p_retry_cmd;
+                rw_cb.tcb.i93.p_retry_cmd = NULL;
+                rw_i93_send_to_lower (p_buf);
+            }
         }
         else
         {
@@ -3053,13 +3225,16 @@ static void rw_i93_data_cback (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *p_
             if (  (p_i93->retry_count < RW_MAX_RETRIES)
                 &&(p_i93->p_retry_cmd)  )
             {
-                p_i93->retry_count++;
+                if (!rw_i93_retry_smaller_read ())
+                {
+                    p_i93->retry_count++;
 
-                RW_TRACE_ERROR1 ("rw_i93_data_cback (): retry_count = %d", p_i93->retry_count);
+                    RW_TRACE_ERROR1 ("rw_i93_data_cback (): retry_count = %d", p_i93->retry_count);
 
-                p_resp = p_i93->p_retry_cmd;
-                p_i93->p_retry_cmd = NULL;
-                rw_i93_send_to_lower (p_resp);
+                    p_resp = p_i93->p_retry_cmd;
+                    p_i93->p_retry_cmd = NULL;
+                    rw_i93_send_to_lower (p_resp);
+                }
             }
             else
             {
@@ -3096,6 +3271,16 @@ static void rw_i93_data_cback (UINT8 conn_id, tNFC_CONN_EVT event, tNFC_CONN *p_
         p_i93->retry_count = 0;
     }
 
+    /* got response of read multi block without error on the link */
+    if (  (p_i93->sent_cmd == I93_CMD_READ_MULTI_BLOCK)
+        &&(  (p_i93->state == RW_I93_STATE_DETECT_NDEF)
+           ||(p_i93->state == RW_I93_STATE_READ_NDEF)  )
+        &&(p_resp->len)
+        &&(!(*((UINT8 *) (p_resp + 1) + p_resp->offset) & I93_FLAG_ERROR_DETECTED))  )
+    {
+        rw_i93_update_read_blocks (TRUE);
+    }
+
 #if (BT_TRACE_PROTOCOL == TRUE)
     DispRWI93Tag (p_resp, TRUE, p_i93->sent_cmd);
 #endif
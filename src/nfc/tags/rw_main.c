@@ -196,6 +196,52 @@ tNFC_STATUS RW_SendRawFrame (UINT8 *p_raw_data, UINT16 data_len)
     return status;
 }
 
+/*******************************************************************************
+**
+** Function         rw_ndef_chg_ind
+**
+** Description      Fold tag data read during NDEF detection into a change
+**                  indicator (FNV-1a). Start with RW_NDEF_CHG_IND_INIT.
+**
+** Returns          Updated change indicator
+**
+*******************************************************************************/
+UINT32 rw_ndef_chg_ind (UINT32 chg_ind, UINT8 *p_data, UINT16 len)
+{
+    while (len--)
+    {
+        chg_ind ^= *p_data++;
+        chg_ind *= 0x01000193;
+    }
+
+    return (chg_ind);
+}
+
+/*******************************************************************************
+**
+** Function         RW_GetNdefChangeInd
+**
+** Description      This function returns the change indicator taken by the
+**                  last successful NDEF detection on the activated tag.
+**                  It is computed from data read anyway during detection
+**                  (T2T CC/lock bytes and first data blocks, T3T attribute
+**                  block, T4T NLEN and CC file, I93 block holding the NDEF
+**                  TLV), so a tag presented again with the same UID and
+**                  indicator very likely still holds the same NDEF message.
+**
+** Returns          NFC_STATUS_OK if a change indicator is available
+**                  NFC_STATUS_FAILED otherwise
+**
+*******************************************************************************/
+tNFC_STATUS RW_GetNdefChangeInd (UINT32 *p_chg_ind)
+{
+    if (rw_cb.ndef_chg_ind == 0)
+        return (NFC_STATUS_FAILED);
+
+    *p_chg_ind = rw_cb.ndef_chg_ind;
+    return (NFC_STATUS_OK);
+}
+
 /*******************************************************************************
 **
 ** Function         RW_SetActivatedTagType
@@ -220,6 +266,7 @@ tNFC_STATUS RW_SetActivatedTagType (tNFC_ACTIVATE_DEVT *p_activate_params, tRW_C
 
     /* Reset tag-specific area of control block */
     memset (&rw_cb.tcb, 0, sizeof (tRW_TCB));
+    rw_cb.ndef_chg_ind = 0;
 
 #if (defined (RW_STATS_INCLUDED) && (RW_STATS_INCLUDED == TRUE))
     /* Reset RW stats */
@@ -86,6 +86,7 @@ static void rw_t2t_proc_data (UINT8 conn_id, tNFC_CONN_EVT event, BT_HDR *p_pkt)
     tRW_READ_DATA           evt_data = {0};
     tT2T_CMD_RSP_INFO       *p_cmd_rsp_info = (tT2T_CMD_RSP_INFO *) rw_cb.tcb.t2t.p_cmd_rsp_info;
     tRW_DETECT_NDEF_DATA    ndef_data;
+    UINT16                  rsp_len;
 #if (BT_TRACE_VERBOSE == TRUE)
     UINT8                   begin_state     = p_t2t->state;
 #endif
@@ -110,7 +111,13 @@ static void rw_t2t_proc_data (UINT8 conn_id, tNFC_CONN_EVT event, BT_HDR *p_pkt)
 
     RW_TRACE_EVENT2 ("RW RECV [%s]:0x%x RSP", t2t_info_to_str (p_cmd_rsp_info), p_cmd_rsp_info->opcode);
 
-    if (  (p_pkt->len != p_cmd_rsp_info->rsp_len)
+    /* FAST_READ response length depends on the range of blocks read */
+    if (p_cmd_rsp_info->opcode == T2T_CMD_FAST_READ)
+        rsp_len = p_t2t->read_len;
+    else
+        rsp_len = p_cmd_rsp_info->rsp_len;
+
+    if (  (p_pkt->len != rsp_len)
         &&(p_pkt->len != p_cmd_rsp_info->nack_rsp_len)
         &&(p_t2t->substate != RW_T2T_SUBSTATE_WAIT_SELECT_SECTOR)  )
     {
@@ -155,7 +162,13 @@ static void rw_t2t_proc_data (UINT8 conn_id, tNFC_CONN_EVT event, BT_HDR *p_pkt)
     {
         evt_data.status = NFC_STATUS_FAILED;
     }
-    else if (p_pkt->len == p_cmd_rsp_info->rsp_len)
+    else if (p_t2t->substate == RW_T2T_SUBSTATE_WAIT_GET_VERSION)
+    {
+        /* A NACK only means the tag does not support GET_VERSION */
+        b_notify = FALSE;
+        rw_t2t_handle_version_rsp (p, p_pkt->len);
+    }
+    else if (p_pkt->len == rsp_len)
     {
         /* If the response length indicates positive response or cannot be known from length then assume success */
         evt_data.status  = NFC_STATUS_OK;
@@ -523,6 +536,13 @@ static void rw_t2t_process_error (void)
 
     RW_TRACE_DEBUG1 ("rw_t2t_process_error () State: %u", p_t2t->state);
 
+    if (p_t2t->substate == RW_T2T_SUBSTATE_WAIT_GET_VERSION)
+    {
+        /* No use retrying GET_VERSION, go on detecting with READ */
+        rw_t2t_handle_version_rsp (NULL, 0);
+        return;
+    }
+
     /* Retry sending command if retry-count < max */
     if (rw_cb.cur_retry < RW_MAX_RETRIES)
     {
@@ -728,6 +748,7 @@ tNFC_STATUS rw_t2t_read (UINT16 block)
 
 
     read_cmd[0] = block % T2T_BLOCKS_PER_SECTOR;
+    p_t2t->read_len = T2T_READ_DATA_LEN;
     if (p_t2t->sector != block/T2T_BLOCKS_PER_SECTOR)
     {
         sector_byte2[0] = 0xFF;
@@ -762,6 +783,87 @@ tNFC_STATUS rw_t2t_read (UINT16 block)
     return status;
 }
 
+/*******************************************************************************
+**
+** Function         rw_t2t_read_range
+**
+** Description      This function issues Type 2 Tag FAST_READ command for the
+**                  blocks from 'block' to 'end_block'. The range is cut to
+**                  what fits in one NCI data packet and to the current sector.
+**                  If the tag does not support FAST_READ, the block is in a
+**                  different sector or the range is not longer than one READ,
+**                  READ command is issued for 'block' instead.
+**                  The number of bytes requested is kept in read_len.
+**
+** Returns          tNFC_STATUS
+**
+*******************************************************************************/
+tNFC_STATUS rw_t2t_read_range (UINT16 block, UINT16 end_block)
+{
+    tNFC_STATUS     status;
+    tRW_T2T_CB      *p_t2t = &rw_cb.tcb.t2t;
+    tNFC_CONN_CB    *p_cb;
+    UINT16          max_blocks = RW_T2T_FAST_READ_MAX_BLOCKS;
+    UINT16          sector_end;
+    UINT8           read_cmd[2];
+
+    if (  (!p_t2t->b_fast_read)
+        ||(p_t2t->sector != block/T2T_BLOCKS_PER_SECTOR)  )
+    {
+        return rw_t2t_read (block);
+    }
+
+    /* Do not let the response be segmented by NFCC or exceed RW buffer */
+    if (  ((p_cb = nfc_find_conn_cb_by_conn_id (NFC_RF_CONN_ID)) != NULL)
+        &&(p_cb->buff_size / T2T_BLOCK_LEN < max_blocks)  )
+    {
+        max_blocks = p_cb->buff_size / T2T_BLOCK_LEN;
+    }
+    if (RW_T2T_MAX_DATA_PER_READ / T2T_BLOCK_LEN < max_blocks)
+        max_blocks = RW_T2T_MAX_DATA_PER_READ / T2T_BLOCK_LEN;
+
+    /* FAST_READ does not cross sector boundary */
+    sector_end = (p_t2t->sector + 1) * T2T_BLOCKS_PER_SECTOR - 1;
+    if (end_block > sector_end)
+        end_block = sector_end;
+    if (end_block >= block + max_blocks)
+        end_block = block + max_blocks - 1;
+
+    if (end_block < block + T2T_READ_BLOCKS)
+        return rw_t2t_read (block);
+
+    read_cmd[0] = block % T2T_BLOCKS_PER_SECTOR;
+    read_cmd[1] = end_block % T2T_BLOCKS_PER_SECTOR;
+    p_t2t->read_len = (end_block - block + 1) * T2T_BLOCK_LEN;
+
+    if ((status = rw_t2t_send_cmd (T2T_CMD_FAST_READ, read_cmd)) == NFC_STATUS_OK)
+    {
+        p_t2t->block_read = block;
+        RW_TRACE_EVENT2 ("rw_t2t_read_range Sent Command for Blocks: %u - %u", block, end_block);
+    }
+
+    return status;
+}
+
+/*******************************************************************************
+**
+** Function         rw_t2t_get_version
+**
+** Description      This function issues GET_VERSION command to find out if
+**                  the tag is NTAG / Ultralight EV1, which support FAST_READ.
+**
+** Returns          tNFC_STATUS
+**
+*******************************************************************************/
+tNFC_STATUS rw_t2t_get_version (void)
+{
+    tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
+
+    p_t2t->b_version_read = TRUE;
+
+    return rw_t2t_send_cmd (T2T_CMD_GET_VERSION, NULL);
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t2t_write
@@ -1153,6 +1255,8 @@ static char *rw_t2t_get_substate_name (UINT8 substate)
         return ("RW_T2T_SUBSTATE_WAIT_WRITE_NDEF_LEN_NEXT_BLOCK");
     case RW_T2T_SUBSTATE_WAIT_WRITE_TERM_TLV_CMPLT:
         return ("RW_T2T_SUBSTATE_WAIT_WRITE_TERM_TLV_CMPLT");
+    case RW_T2T_SUBSTATE_WAIT_GET_VERSION:
+        return ("RW_T2T_SUBSTATE_WAIT_GET_VERSION");
     default:
         return ("???? UNKNOWN SUBSTATE");
     }
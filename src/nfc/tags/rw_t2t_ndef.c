@@ -66,6 +66,9 @@ static tNFC_STATUS rw_t2t_format_tag (void);
 static tNFC_STATUS rw_t2t_soft_lock_tag (void);
 static tNFC_STATUS rw_t2t_set_dynamic_lock_bits (UINT8 *p_data);
 static void rw_t2t_ntf_tlv_detect_complete (tNFC_STATUS status);
+static tNFC_STATUS rw_t2t_start_tlv_detect (void);
+static UINT16 rw_t2t_get_data_end_block (void);
+static UINT16 rw_t2t_get_ndef_end_block (UINT16 block);
 
 const UINT8 rw_t2t_mask_bits[8] =
 {0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80};
@@ -246,8 +249,69 @@ static void rw_t2t_handle_cc_read_rsp (void)
         return;
     }
 
+    if (rw_t2t_start_tlv_detect () != NFC_STATUS_OK)
+    {
+        rw_t2t_ntf_tlv_detect_complete (NFC_STATUS_FAILED);
+    }
+}
+
+/*******************************************************************************
+**
+** Function         rw_t2t_start_tlv_detect
+**
+** Description      Read the first data blocks to search for TLVs. On a NXP tag
+**                  that can be NTAG or Ultralight EV1, GET_VERSION is sent
+**                  first, once per activation, to know if FAST_READ can be
+**                  used. Ultralight and Ultralight C tags (TMS 0x06 and 0x12)
+**                  are not asked, as they halt on an unknown command.
+**
+** Returns          NFC_STATUS_OK, if a command was sent
+**
+*******************************************************************************/
+static tNFC_STATUS rw_t2t_start_tlv_detect (void)
+{
+    tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
+
+    if (  (RW_T2T_FAST_READ_MAX_BLOCKS > T2T_READ_BLOCKS)
+        &&(!p_t2t->b_version_read)
+        &&(p_t2t->tag_hdr[0] == TAG_MIFARE_MID)
+        &&(p_t2t->tag_hdr[T2T_CC2_TMS_BYTE] != T2T_CC2_TMS_MUL)
+        &&(p_t2t->tag_hdr[T2T_CC2_TMS_BYTE] != T2T_CC2_TMS_MULC)  )
+    {
+        p_t2t->substate = RW_T2T_SUBSTATE_WAIT_GET_VERSION;
+        return rw_t2t_get_version ();
+    }
+
     p_t2t->substate = RW_T2T_SUBSTATE_WAIT_TLV_DETECT;
+    return rw_t2t_read ((UINT16) T2T_FIRST_DATA_BLOCK);
+}
 
+/*******************************************************************************
+**
+** Function         rw_t2t_handle_version_rsp
+**
+** Description      Handle response to GET_VERSION and continue TLV detection.
+**                  p_data is NULL if the tag did not respond.
+**
+** Returns          none
+**
+*******************************************************************************/
+void rw_t2t_handle_version_rsp (UINT8 *p_data, UINT16 len)
+{
+    tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
+
+    p_t2t->b_fast_read = FALSE;
+    if (  (p_data != NULL)
+        &&(len == T2T_GET_VERSION_RSP_LEN)
+        &&(p_data[T2T_VERSION_VENDOR_BYTE] == TAG_MIFARE_MID)
+        &&(  (p_data[T2T_VERSION_TYPE_BYTE] == T2T_VERSION_TYPE_UL)
+           ||(p_data[T2T_VERSION_TYPE_BYTE] == T2T_VERSION_TYPE_NTAG)  )  )
+    {
+        p_t2t->b_fast_read = TRUE;
+    }
+    RW_TRACE_DEBUG1 ("rw_t2t_handle_version_rsp - FAST_READ supported: %u", p_t2t->b_fast_read);
+
+    p_t2t->substate = RW_T2T_SUBSTATE_WAIT_TLV_DETECT;
     if (rw_t2t_read ((UINT16) T2T_FIRST_DATA_BLOCK) != NFC_STATUS_OK)
     {
         rw_t2t_ntf_tlv_detect_complete (NFC_STATUS_FAILED);
@@ -280,8 +344,14 @@ static void rw_t2t_ntf_tlv_detect_complete (tNFC_STATUS status)
         ndef_data.cur_size  = p_t2t->ndef_msg_len;
 
         if (status == NFC_STATUS_OK)
+        {
             ndef_data.flags   |= RW_NDEF_FL_FORMATED;
 
+            /* Change indicator from static lock bytes, CC and blocks 4 - 7 holding the NDEF TLV header */
+            rw_cb.ndef_chg_ind = rw_ndef_chg_ind (RW_NDEF_CHG_IND_INIT, &p_t2t->tag_hdr[T2T_STATIC_LOCK0], T2T_READ_DATA_LEN - T2T_STATIC_LOCK0);
+            rw_cb.ndef_chg_ind = rw_ndef_chg_ind (rw_cb.ndef_chg_ind, p_t2t->tag_data, T2T_READ_DATA_LEN);
+        }
+
         if (p_t2t->tag_hdr[T2T_CC3_RWA_BYTE] == T2T_CC3_RWA_RW)
             ndef_data.max_size = (UINT32) rw_t2t_get_ndef_max_size ();
         else
@@ -456,7 +526,7 @@ static void rw_t2t_handle_tlv_detect_rsp (UINT8 *p_data)
 
     p_t2t->segment = 0;
 
-    for (offset = 0; offset < T2T_READ_DATA_LEN  && !failed && !found;)
+    for (offset = 0; offset < p_t2t->read_len  && !failed && !found;)
     {
         if (rw_t2t_is_lock_res_byte ((UINT16) (p_t2t->work_offset + offset)) == TRUE)
         {
@@ -753,7 +823,7 @@ static void rw_t2t_handle_tlv_detect_rsp (UINT8 *p_data)
     }
 
 
-    p_t2t->work_offset += T2T_READ_DATA_LEN;
+    p_t2t->work_offset += p_t2t->read_len;
 
     event = rw_t2t_info_to_event (p_cmd_rsp_info);
 
@@ -775,7 +845,8 @@ static void rw_t2t_handle_tlv_detect_rsp (UINT8 *p_data)
         }
         else
         {
-            if (rw_t2t_read ((UINT16) ((p_t2t->work_offset / T2T_BLOCK_LEN) + T2T_FIRST_DATA_BLOCK)) != NFC_STATUS_OK)
+            /* work_offset is the offset of the next unread byte in the tag */
+            if (rw_t2t_read_range ((UINT16) (p_t2t->work_offset / T2T_BLOCK_LEN), rw_t2t_get_data_end_block ()) != NFC_STATUS_OK)
                 failed = TRUE;
         }
     }
@@ -1064,6 +1135,56 @@ tNFC_STATUS rw_t2t_read_ndef_next_block (UINT16 block)
     return status;
 }
 
+/*******************************************************************************
+**
+** Function         rw_t2t_get_data_end_block
+**
+** Description      This function returns the last block of the tag data area
+**                  as given by the CC
+**
+** Returns          block number
+**
+*******************************************************************************/
+static UINT16 rw_t2t_get_data_end_block (void)
+{
+    tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
+
+    return (UINT16) (T2T_FIRST_DATA_BLOCK - 1 + (p_t2t->tag_hdr[T2T_CC2_TMS_BYTE] * T2T_TMS_TAG_FACTOR) / T2T_BLOCK_LEN);
+}
+
+/*******************************************************************************
+**
+** Function         rw_t2t_get_ndef_end_block
+**
+** Description      This function returns the block holding the last byte of
+**                  the NDEF message not read yet, when reading from 'block'.
+**                  Lock and reserved bytes on the way are accounted for.
+**
+** Returns          block number
+**
+*******************************************************************************/
+static UINT16 rw_t2t_get_ndef_end_block (UINT16 block)
+{
+    tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
+    UINT16      offset = block * T2T_BLOCK_LEN;
+    UINT16      end_offset = (rw_t2t_get_data_end_block () + 1) * T2T_BLOCK_LEN;
+    UINT16      remaining = p_t2t->ndef_msg_len - p_t2t->work_offset;
+
+    /* Message may start in the middle of the first block read */
+    if (offset < p_t2t->ndef_msg_offset)
+        offset = p_t2t->ndef_msg_offset;
+
+    while (  (remaining > 0)
+           &&(offset < end_offset)  )
+    {
+        if (rw_t2t_is_lock_res_byte (offset) == FALSE)
+            remaining--;
+        offset++;
+    }
+
+    return (UINT16) ((offset - 1) / T2T_BLOCK_LEN);
+}
+
 /*******************************************************************************
 **
 ** Function         rw_t2t_is_read_before_write_block
@@ -1582,12 +1703,13 @@ static void rw_t2t_handle_ndef_read_rsp (UINT8 *p_data)
     tRW_READ_DATA    evt_data;
     UINT16          len;
     UINT16          offset;
+    UINT16          block;
     BOOLEAN         failed = FALSE;
     BOOLEAN         done   = FALSE;
 
     /* On the first read, adjust for any partial block offset */
     offset = 0;
-    len    = T2T_READ_DATA_LEN;
+    len    = p_t2t->read_len;
 
     if (p_t2t->work_offset == 0)
     {
@@ -1616,8 +1738,9 @@ static void rw_t2t_handle_ndef_read_rsp (UINT8 *p_data)
     }
     else
     {
-        /* Read next 4 blocks */
-        if (rw_t2t_read ((UINT16) (p_t2t->block_read + T2T_READ_BLOCKS)) != NFC_STATUS_OK)
+        /* Read next blocks, as many as needed for rest of the message */
+        block = (UINT16) (p_t2t->block_read + (len / T2T_BLOCK_LEN));
+        if (rw_t2t_read_range (block, rw_t2t_get_ndef_end_block (block)) != NFC_STATUS_OK)
             failed = TRUE;
     }
 
@@ -2858,7 +2981,6 @@ tNFC_STATUS RW_T2tLocateTlv (UINT8 tlv_type)
 {
     tRW_T2T_CB  *p_t2t = &rw_cb.tcb.t2t;
     tNFC_STATUS status;
-    UINT16      block;
 
     if (p_t2t->state != RW_T2T_STATE_IDLE)
     {
@@ -2917,21 +3039,20 @@ tNFC_STATUS RW_T2tLocateTlv (UINT8 tlv_type)
         p_t2t->prop_msg_len     = 0;
     }
 
+    /* Start reading tag, looking for the specified TLV */
     if (!p_t2t->b_read_hdr)
     {
         /* First read CC block */
-        block                   = 0;
         p_t2t->substate         = RW_T2T_SUBSTATE_WAIT_READ_CC;
+        status = rw_t2t_read (0);
     }
     else
     {
         /* Read first data block */
-        block                   = T2T_FIRST_DATA_BLOCK;
-        p_t2t->substate         = RW_T2T_SUBSTATE_WAIT_TLV_DETECT;
+        status = rw_t2t_start_tlv_detect ();
     }
 
-    /* Start reading tag, looking for the specified TLV */
-    if ((status = rw_t2t_read ((UINT16) block)) == NFC_STATUS_OK)
+    if (status == NFC_STATUS_OK)
     {
         p_t2t->state    = RW_T2T_STATE_DETECT_TLV;
     }
@@ -3032,12 +3153,13 @@ tNFC_STATUS RW_T2tReadNDef (UINT8 *p_buffer, UINT16 buf_len)
     {
         p_t2t->state        = RW_T2T_STATE_READ_NDEF;
         p_t2t->block_read   = T2T_FIRST_DATA_BLOCK;
+        p_t2t->read_len     = T2T_READ_DATA_LEN;
         rw_t2t_handle_ndef_read_rsp (p_t2t->tag_data);
     }
     else
     {
         /* Start reading NDEF Message */
-        if ((status = rw_t2t_read (block)) == NFC_STATUS_OK)
+        if ((status = rw_t2t_read_range (block, rw_t2t_get_ndef_end_block (block))) == NFC_STATUS_OK)
         {
             p_t2t->state    = RW_T2T_STATE_READ_NDEF;
         }
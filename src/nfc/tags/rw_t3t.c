@@ -49,6 +49,7 @@
 #define RW_T3T_POLL_CMD_TIMEOUT_TICKS                               ((RW_T3T_TOUT_RESP*2*QUICK_TIMER_TICKS_PER_SEC) / 1000)
 #define RW_T3T_DEFAULT_CMD_TIMEOUT_TICKS                            ((RW_T3T_TOUT_RESP*QUICK_TIMER_TICKS_PER_SEC) / 1000)
 #define RW_T3T_RAW_FRAME_CMD_TIMEOUT_TICKS                          (RW_T3T_DEFAULT_CMD_TIMEOUT_TICKS * 4)
+#define RW_T3T_MRTI_BASE_US                                         302     /* Unit of MRTI in PMm (256 * 16 / fc), in us */
 
 /* Macro to extract major version from NDEF version byte */
 #define T3T_GET_MAJOR_VERSION(ver)      (ver>>4)
@@ -224,6 +225,7 @@ void rw_t3t_process_error (tNFC_STATUS status)
 #endif  /* RW_STATS_INCLUDED */
 
         p_cb->rw_state = RW_T3T_STATE_IDLE;
+        p_cb->flags   &= ~RW_T3T_FL_BATCH;
 
         /* Notify app of result (if there was a pending command) */
         if (p_cb->cur_cmd < RW_T3T_CMD_MAX)
@@ -1048,6 +1050,7 @@ tNFC_STATUS rw_t3t_send_check_cmd (tRW_T3T_CB *p_cb, UINT8 num_blocks, tT3T_BLOC
     tNFC_STATUS retval = NFC_STATUS_OK;
 
     p_cb->cur_cmd = RW_T3T_CMD_CHECK;
+    p_cb->flags  &= ~RW_T3T_FL_BATCH;
     if ((p_cmd_buf = rw_t3t_get_cmd_buf ()) != NULL)
     {
         /* Construct T3T message */
@@ -1084,6 +1087,7 @@ tNFC_STATUS rw_t3t_send_update_cmd (tRW_T3T_CB *p_cb, UINT8 num_blocks, tT3T_BLO
     tNFC_STATUS retval = NFC_STATUS_OK;
 
     p_cb->cur_cmd = RW_T3T_CMD_UPDATE;
+    p_cb->flags  &= ~RW_T3T_FL_BATCH;
     if ((p_cmd_buf = rw_t3t_get_cmd_buf ()) != NULL)
     {
         /* Construct T3T message */
@@ -1107,6 +1111,163 @@ tNFC_STATUS rw_t3t_send_update_cmd (tRW_T3T_CB *p_cb, UINT8 num_blocks, tT3T_BLO
     return(retval);
 }
 
+/*****************************************************************************
+**
+** Function         rw_t3t_get_mrti_tout
+**
+** Description      Get response timeout of CHECK or UPDATE from MRTI of PMm
+**                  T = 0.302ms * ((B + 1) + n * (A + 1)) * 4^E
+**
+** Returns          timeout in quick timer ticks
+**
+*****************************************************************************/
+static UINT32 rw_t3t_get_mrti_tout (UINT8 mrti, UINT8 num_blocks)
+{
+    UINT32 tout_us;
+
+    tout_us  = RW_T3T_MRTI_BASE_US * (((mrti >> 3) & 0x07) + 1 + (UINT32) num_blocks * ((mrti & 0x07) + 1));
+    tout_us <<= 2 * (mrti >> 6);
+
+    /* Add default timeout as margin for NCI transport */
+    return (RW_T3T_DEFAULT_CMD_TIMEOUT_TICKS + (tout_us * QUICK_TIMER_TICKS_PER_SEC) / 1000000);
+}
+
+/*****************************************************************************
+**
+** Function         rw_t3t_get_batch_num_blocks
+**
+** Description      Get how many of the remaining blocks of the batch fit into
+**                  one CHECK or UPDATE command (max blocks, max services and
+**                  max NFC-F payload length)
+**
+** Returns          Number of blocks
+**
+*****************************************************************************/
+static UINT8 rw_t3t_get_batch_num_blocks (tRW_T3T_CB *p_cb)
+{
+    tT3T_BLOCK_DESC *p_blocks = &p_cb->p_batch_blocks[p_cb->batch_offset];
+    UINT16 remaining = p_cb->batch_num_blocks - p_cb->batch_offset;
+    UINT16 service_list[T3T_MSG_SERVICE_LIST_MAX];
+    UINT16 msg_len, blk_len;
+    UINT8 num_blocks, num_services = 0, max_services, i;
+
+    max_services = (p_cb->cur_cmd == RW_T3T_CMD_CHECK) ? T3T_MSG_NUM_SERVICES_CHECK_MAX : T3T_MSG_NUM_SERVICES_UPDATE_MAX;
+
+    /* SoD, command code, IDm, number of services and number of blocks */
+    msg_len = T3T_MSG_CMD_COMMON_HDR_LEN + 1;
+
+    for (num_blocks = 0; (num_blocks < p_cb->batch_max_blocks) && (num_blocks < remaining); num_blocks++)
+    {
+        /* Block list element is 2 or 3 bytes */
+        blk_len = (p_blocks[num_blocks].block_number > 0xFF) ? 3 : 2;
+
+        if (p_cb->cur_cmd == RW_T3T_CMD_UPDATE)
+            blk_len += T3T_MSG_BLOCKSIZE;
+
+        for (i = 0; i < num_services; i++)
+        {
+            if (service_list[i] == p_blocks[num_blocks].service_code)
+                break;
+        }
+
+        if (i == num_services)
+        {
+            /* New service code is needed in the service code list */
+            if (num_services == max_services)
+                break;
+            blk_len += 2;
+        }
+
+        if (msg_len + blk_len > T3T_NFC_F_MAX_PAYLOAD_LEN)
+            break;
+
+        if (i == num_services)
+            service_list[num_services++] = p_blocks[num_blocks].service_code;
+
+        msg_len += blk_len;
+    }
+
+    return (num_blocks);
+}
+
+/*****************************************************************************
+**
+** Function         rw_t3t_send_next_batch_cmd
+**
+** Description      Send CHECK or UPDATE command for next blocks of the batch
+**
+** Returns          tNFC_STATUS
+**
+*****************************************************************************/
+static tNFC_STATUS rw_t3t_send_next_batch_cmd (tRW_T3T_CB *p_cb)
+{
+    BT_HDR *p_cmd_buf;
+    UINT8 *p, *p_cmd_start, *p_data;
+    UINT8 num_blocks, mrti;
+
+    if ((p_cmd_buf = rw_t3t_get_cmd_buf ()) == NULL)
+        return (NFC_STATUS_NO_BUFFERS);
+
+    num_blocks = rw_t3t_get_batch_num_blocks (p_cb);
+
+    RW_TRACE_DEBUG3 ("rw_t3t_send_next_batch_cmd: blocks %i-%i of %i",
+                     p_cb->batch_offset, p_cb->batch_offset + num_blocks - 1, p_cb->batch_num_blocks);
+
+    /* Construct T3T message */
+    p = p_cmd_start = (UINT8 *) (p_cmd_buf+1) + p_cmd_buf->offset;
+    rw_t3t_message_set_block_list (p_cb, &p, num_blocks, &p_cb->p_batch_blocks[p_cb->batch_offset]);
+
+    if (p_cb->cur_cmd == RW_T3T_CMD_UPDATE)
+    {
+        /* Add data blocks to the message */
+        p_data = p_cb->p_batch_data + p_cb->batch_offset * T3T_MSG_BLOCKSIZE;
+        ARRAY_TO_STREAM (p, p_data, num_blocks * T3T_MSG_BLOCKSIZE);
+        mrti = p_cb->mrti_update;
+    }
+    else
+    {
+        mrti = p_cb->mrti_check;
+    }
+
+    /* Calculate length of message */
+    p_cmd_buf->len = (UINT16) (p - p_cmd_start);
+
+    p_cb->batch_cur_blocks = num_blocks;
+
+    /* Send the T3T message */
+    return (rw_t3t_send_cmd (p_cb, p_cb->cur_cmd, p_cmd_buf, rw_t3t_get_mrti_tout (mrti, num_blocks)));
+}
+
+/*****************************************************************************
+**
+** Function         rw_t3t_start_batch
+**
+** Description      Start RW_T3tCheckBatch or RW_T3tUpdateBatch
+**
+** Returns          tNFC_STATUS
+**
+*****************************************************************************/
+static tNFC_STATUS rw_t3t_start_batch (tRW_T3T_CB *p_cb, UINT8 rw_t3t_cmd, UINT8 max_blocks,
+                                       UINT16 num_blocks, tT3T_BLOCK_DESC *p_t3t_blocks, UINT8 *p_data)
+{
+    tNFC_STATUS retval;
+
+    p_cb->cur_cmd          = rw_t3t_cmd;
+    p_cb->p_batch_blocks   = p_t3t_blocks;
+    p_cb->p_batch_data     = p_data;
+    p_cb->batch_num_blocks = num_blocks;
+    p_cb->batch_offset     = 0;
+    p_cb->batch_max_blocks = max_blocks;
+    p_cb->flags           |= RW_T3T_FL_BATCH;
+
+    if ((retval = rw_t3t_send_next_batch_cmd (p_cb)) != NFC_STATUS_OK)
+    {
+        p_cb->flags &= ~RW_T3T_FL_BATCH;
+    }
+
+    return (retval);
+}
+
 /*****************************************************************************
 **
 ** Function         rw_t3t_check_mc_block
@@ -1295,6 +1456,9 @@ void rw_t3t_act_handle_ndef_detect_rsp (tRW_T3T_CB *p_cb, BT_HDR *p_msg_rsp)
                     p_cb->ndef_attrib.rwflag,
                     p_cb->ndef_attrib.ln);
 
+                /* Change indicator from the attribute block (WriteFlag, Ln and checksum) */
+                rw_cb.ndef_chg_ind = rw_ndef_chg_ind (RW_NDEF_CHG_IND_INIT, &p_t3t_rsp[T3T_MSG_RSP_OFFSET_CHECK_DATA], T3T_MSG_BLOCKSIZE);
+
                 /* Set data for RW_T3T_NDEF_DETECT_EVT */
                 evt_data.status = p_cb->ndef_attrib.status;
                 evt_data.cur_size = p_cb->ndef_attrib.ln;
@@ -1354,9 +1518,21 @@ void rw_t3t_act_handle_check_rsp (tRW_T3T_CB *p_cb, BT_HDR *p_msg_rsp)
         evt_data.status = NFC_STATUS_OK;
         evt_data.p_data = p_msg_rsp;
         (*(rw_cb.p_cback)) (RW_T3T_CHECK_EVT, (tRW_DATA *) &evt_data);
-    }
 
+        /* If RW_T3tCheckBatch has more blocks to read, then send next CHECK command */
+        if (p_cb->flags & RW_T3T_FL_BATCH)
+        {
+            p_cb->batch_offset += p_cb->batch_cur_blocks;
 
+            if (p_cb->batch_offset < p_cb->batch_num_blocks)
+            {
+                if ((nfc_status = rw_t3t_send_next_batch_cmd (p_cb)) == NFC_STATUS_OK)
+                    return;
+            }
+        }
+    }
+
+    p_cb->flags &= ~RW_T3T_FL_BATCH;
     p_cb->rw_state = RW_T3T_STATE_IDLE;
 
     (*(rw_cb.p_cback)) (RW_T3T_CHECK_CPLT_EVT, (tRW_DATA *) &nfc_status);
@@ -1391,8 +1567,24 @@ void rw_t3t_act_handle_update_rsp (tRW_T3T_CB *p_cb, BT_HDR *p_msg_rsp)
     {
         /* Copy incoming data into buffer */
         evt_data.status = NFC_STATUS_OK;
+
+        /* If RW_T3tUpdateBatch has more blocks to write, then send next UPDATE command */
+        if (p_cb->flags & RW_T3T_FL_BATCH)
+        {
+            p_cb->batch_offset += p_cb->batch_cur_blocks;
+
+            if (p_cb->batch_offset < p_cb->batch_num_blocks)
+            {
+                if ((evt_data.status = rw_t3t_send_next_batch_cmd (p_cb)) == NFC_STATUS_OK)
+                {
+                    GKI_freebuf (p_msg_rsp);
+                    return;
+                }
+            }
+        }
     }
 
+    p_cb->flags &= ~RW_T3T_FL_BATCH;
     p_cb->rw_state = RW_T3T_STATE_IDLE;
 
     (*(rw_cb.p_cback)) (RW_T3T_UPDATE_CPLT_EVT, (tRW_DATA *)&evt_data);
@@ -2345,6 +2537,8 @@ tNFC_STATUS rw_t3t_select (UINT8 peer_nfcid2[NCI_RF_F_UID_LEN], UINT8 mrti_check
     RW_TRACE_API0 ("rw_t3t_select");
 
     memcpy (p_cb->peer_nfcid2, peer_nfcid2, NCI_NFCID2_LEN); /* Store tag's NFCID2 */
+    p_cb->mrti_check  = mrti_check;                         /* Store MRTI for CHECK/UPDATE response timeout */
+    p_cb->mrti_update = mrti_update;
     p_cb->ndef_attrib.status = NFC_STATUS_NOT_INITIALIZED;  /* Indicate that NDEF detection has not been performed yet */
     p_cb->rw_state = RW_T3T_STATE_IDLE;
     p_cb->flags = 0;
@@ -2727,6 +2921,108 @@ tNFC_STATUS RW_T3tUpdate (UINT8 num_blocks, tT3T_BLOCK_DESC *t3t_blocks, UINT8 *
     return (retval);
 }
 
+/*****************************************************************************
+**
+** Function         RW_T3tCheckBatch
+**
+** Description
+**      Read (non-NDEF) contents of any number of blocks, from up to
+**      T3T_MSG_NUM_SERVICES_CHECK_MAX services per command, from a Type3 tag.
+**
+**      The block list is split, in order, into as few CHECK commands as
+**      possible. Each command has at most max_blocks blocks (NBr of the
+**      tag, or 0 for T3T_MSG_NUM_BLOCKS_CHECK_MAX). The response timeout of
+**      each command is taken from the MRTI of the tag.
+**
+**      The RW_T3T_CHECK_EVT event is used to notify the application of the
+**      block data of each CHECK response. The RW_T3T_CHECK_CPLT_EVT event is
+**      used to notify the application once, when all blocks have been read
+**      or when a command failed.
+**
+**      t3t_blocks must stay valid until RW_T3T_CHECK_CPLT_EVT.
+**
+** Returns
+**      NFC_STATUS_OK: check command started
+**      NFC_STATUS_NO_BUFFERS: unable to allocate a buffer for this operation
+**      NFC_STATUS_FAILED: other error
+**
+*****************************************************************************/
+tNFC_STATUS RW_T3tCheckBatch (UINT8 max_blocks, UINT16 num_blocks, tT3T_BLOCK_DESC *t3t_blocks)
+{
+    tRW_T3T_CB *p_cb = &rw_cb.tcb.t3t;
+
+    RW_TRACE_API2 ("RW_T3tCheckBatch (max_blocks = %i, num_blocks = %i)", max_blocks, num_blocks);
+
+    /* Check if we are in valid state to handle this API */
+    if (p_cb->rw_state != RW_T3T_STATE_IDLE)
+    {
+        RW_TRACE_ERROR1 ("Error: invalid state to handle API (0x%x)", p_cb->rw_state);
+        return (NFC_STATUS_FAILED);
+    }
+
+    if ((num_blocks == 0) || (t3t_blocks == NULL))
+    {
+        RW_TRACE_ERROR0 ("Error: no block to read");
+        return (NFC_STATUS_FAILED);
+    }
+
+    if ((max_blocks == 0) || (max_blocks > T3T_MSG_NUM_BLOCKS_CHECK_MAX))
+        max_blocks = T3T_MSG_NUM_BLOCKS_CHECK_MAX;
+
+    /* Send the first CHECK command */
+    return (rw_t3t_start_batch (p_cb, RW_T3T_CMD_CHECK, max_blocks, num_blocks, t3t_blocks, NULL));
+}
+
+/*****************************************************************************
+**
+** Function         RW_T3tUpdateBatch
+**
+** Description
+**      Write (non-NDEF) contents of any number of blocks, in up to
+**      T3T_MSG_NUM_SERVICES_UPDATE_MAX services per command, to a Type3 tag.
+**
+**      The block list is split, in order, into as few UPDATE commands as
+**      possible. Each command has at most max_blocks blocks (NBw of the
+**      tag, or 0 for T3T_MSG_NUM_BLOCKS_UPDATE_MAX). p_data holds 16 bytes
+**      for each block of the list.
+**
+**      The RW_T3T_UPDATE_CPLT_EVT event is used to notify the application
+**      once, when all blocks have been written or when a command failed.
+**
+**      t3t_blocks and p_data must stay valid until RW_T3T_UPDATE_CPLT_EVT.
+**
+** Returns
+**      NFC_STATUS_OK: update command started
+**      NFC_STATUS_NO_BUFFERS: unable to allocate a buffer for this operation
+**      NFC_STATUS_FAILED: other error
+**
+*****************************************************************************/
+tNFC_STATUS RW_T3tUpdateBatch (UINT8 max_blocks, UINT16 num_blocks, tT3T_BLOCK_DESC *t3t_blocks, UINT8 *p_data)
+{
+    tRW_T3T_CB *p_cb = &rw_cb.tcb.t3t;
+
+    RW_TRACE_API2 ("RW_T3tUpdateBatch (max_blocks = %i, num_blocks = %i)", max_blocks, num_blocks);
+
+    /* Check if we are in valid state to handle this API */
+    if (p_cb->rw_state != RW_T3T_STATE_IDLE)
+    {
+        RW_TRACE_ERROR1 ("Error: invalid state to handle API (0x%x)", p_cb->rw_state);
+        return (NFC_STATUS_FAILED);
+    }
+
+    if ((num_blocks == 0) || (t3t_blocks == NULL) || (p_data == NULL))
+    {
+        RW_TRACE_ERROR0 ("Error: no block to write");
+        return (NFC_STATUS_FAILED);
+    }
+
+    if ((max_blocks == 0) || (max_blocks > T3T_MSG_NUM_BLOCKS_UPDATE_MAX))
+        max_blocks = T3T_MSG_NUM_BLOCKS_UPDATE_MAX;
+
+    /* Send the first UPDATE command */
+    return (rw_t3t_start_batch (p_cb, RW_T3T_CMD_UPDATE, max_blocks, num_blocks, t3t_blocks, p_data));
+}
+
 /*****************************************************************************
 **
 ** Function         RW_T3tPresenceCheck
@@ -727,7 +727,7 @@ static BOOLEAN rw_t4t_read_file (UINT16 offset, UINT16 length, BOOLEAN is_contin
     /* adjust reading length if payload is bigger than max size per single command */
     if (length > p_t4t->max_read_size)
     {
-        length = (UINT8) (p_t4t->max_read_size);
+        length = p_t4t->max_read_size;
     }
 
     p_c_apdu->offset = NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE;
@@ -736,9 +736,23 @@ static BOOLEAN rw_t4t_read_file (UINT16 offset, UINT16 length, BOOLEAN is_contin
     UINT8_TO_BE_STREAM (p, T4T_CMD_CLASS);
     UINT8_TO_BE_STREAM (p, T4T_CMD_INS_READ_BINARY);
     UINT16_TO_BE_STREAM (p, offset);
-    UINT8_TO_BE_STREAM (p, length); /* Le */
 
-    p_c_apdu->len = T4T_CMD_MIN_HDR_SIZE + 1; /* adding Le */
+    if (length > T4T_MAX_LENGTH_LE)
+    {
+        /* max_read_size is bigger than 255 only if MLe allows extended Le */
+        UINT8_TO_BE_STREAM (p, T4T_EXT_LENGTH_PREFIX);
+        UINT16_TO_BE_STREAM (p, length); /* extended Le */
+
+        p_c_apdu->len       = T4T_CMD_MIN_HDR_SIZE + T4T_EXT_LENGTH_SIZE;
+        p_t4t->ext_apdu_len = length;
+    }
+    else
+    {
+        UINT8_TO_BE_STREAM (p, length); /* Le */
+
+        p_c_apdu->len       = T4T_CMD_MIN_HDR_SIZE + 1; /* adding Le */
+        p_t4t->ext_apdu_len = 0;
+    }
 
     if (!rw_t4t_send_to_lower (p_c_apdu))
     {
@@ -824,7 +838,7 @@ static BOOLEAN rw_t4t_update_file (void)
     /* adjust updating length if payload is bigger than max size per single command */
     if (length > p_t4t->max_update_size)
     {
-        length = (UINT8) (p_t4t->max_update_size);
+        length = p_t4t->max_update_size;
     }
 
     p_c_apdu->offset = NCI_MSG_OFFSET_SIZE + NCI_DATA_HDR_SIZE;
@@ -833,11 +847,25 @@ static BOOLEAN rw_t4t_update_file (void)
     UINT8_TO_BE_STREAM (p, T4T_CMD_CLASS);
     UINT8_TO_BE_STREAM (p, T4T_CMD_INS_UPDATE_BINARY);
     UINT16_TO_BE_STREAM (p, p_t4t->rw_offset);
-    UINT8_TO_BE_STREAM (p, length);
 
-    memcpy (p, p_t4t->p_update_data, length);
+    if (length > T4T_MAX_LENGTH_LC)
+    {
+        /* max_update_size is bigger than 255 only if MLc allows extended Lc */
+        UINT8_TO_BE_STREAM (p, T4T_EXT_LENGTH_PREFIX);
+        UINT16_TO_BE_STREAM (p, length); /* extended Lc */
+
+        p_c_apdu->len       = T4T_CMD_EXT_HDR_SIZE + length;
+        p_t4t->ext_apdu_len = length;
+    }
+    else
+    {
+        UINT8_TO_BE_STREAM (p, length);
+
+        p_c_apdu->len       = T4T_CMD_MAX_HDR_SIZE + length;
+        p_t4t->ext_apdu_len = 0;
+    }
 
-    p_c_apdu->len = T4T_CMD_MAX_HDR_SIZE + length;
+    memcpy (p, p_t4t->p_update_data, length);
 
     if (!rw_t4t_send_to_lower (p_c_apdu))
     {
@@ -1527,7 +1555,19 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
                 }
 
                 /* Get max bytes to read per command */
-                if (p_t4t->cc_file.max_le >= RW_T4T_MAX_DATA_PER_READ)
+                if (p_t4t->cc_file.max_le > T4T_MAX_LENGTH_LE)
+                {
+                    /* MLe bigger than 0xFF, use extended Le */
+                    if (p_t4t->cc_file.max_le >= RW_T4T_MAX_EXT_READ_SIZE)
+                    {
+                        p_t4t->max_read_size = RW_T4T_MAX_EXT_READ_SIZE;
+                    }
+                    else
+                    {
+                        p_t4t->max_read_size = p_t4t->cc_file.max_le;
+                    }
+                }
+                else if (p_t4t->cc_file.max_le >= RW_T4T_MAX_DATA_PER_READ)
                 {
                     p_t4t->max_read_size = RW_T4T_MAX_DATA_PER_READ;
                 }
@@ -1536,14 +1576,20 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
                     p_t4t->max_read_size = p_t4t->cc_file.max_le;
                 }
 
-                /* Le: valid range is 0x01 to 0xFF */
-                if (p_t4t->max_read_size >= T4T_MAX_LENGTH_LE)
+                /* Get max bytes to update per command */
+                if (p_t4t->cc_file.max_lc > T4T_MAX_LENGTH_LC)
                 {
-                    p_t4t->max_read_size = T4T_MAX_LENGTH_LE;
+                    /* MLc bigger than 0xFF, use extended Lc */
+                    if (p_t4t->cc_file.max_lc >= RW_T4T_MAX_DATA_PER_EXT_WRITE)
+                    {
+                        p_t4t->max_update_size = RW_T4T_MAX_DATA_PER_EXT_WRITE;
+                    }
+                    else
+                    {
+                        p_t4t->max_update_size = p_t4t->cc_file.max_lc;
+                    }
                 }
-
-                /* Get max bytes to update per command */
-                if (p_t4t->cc_file.max_lc >= RW_T4T_MAX_DATA_PER_WRITE)
+                else if (p_t4t->cc_file.max_lc >= RW_T4T_MAX_DATA_PER_WRITE)
                 {
                     p_t4t->max_update_size = RW_T4T_MAX_DATA_PER_WRITE;
                 }
@@ -1552,15 +1598,13 @@ static void rw_t4t_sm_detect_ndef (BT_HDR *p_r_apdu)
                     p_t4t->max_update_size = p_t4t->cc_file.max_lc;
                 }
 
-                /* Lc: valid range is 0x01 to 0xFF */
-                if (p_t4t->max_update_size >= T4T_MAX_LENGTH_LC)
-                {
-                    p_t4t->max_update_size = T4T_MAX_LENGTH_LC;
-                }
-
                 p_t4t->ndef_length = nlen;
                 p_t4t->state       = RW_T4T_STATE_IDLE;
 
+                /* Change indicator from NLEN and NDEF file control TLV */
+                rw_cb.ndef_chg_ind = rw_ndef_chg_ind (RW_NDEF_CHG_IND_INIT, (UINT8 *) (p_r_apdu + 1) + p_r_apdu->offset, T4T_FILE_LENGTH_SIZE);
+                rw_cb.ndef_chg_ind = rw_ndef_chg_ind (rw_cb.ndef_chg_ind, (UINT8 *) &p_t4t->cc_file.ndef_fc, sizeof (tRW_T4T_NDEF_FC));
+
                 if (rw_cb.p_cback)
                 {
                     rw_data.ndef.status   = NFC_STATUS_OK;
@@ -1636,7 +1680,23 @@ static void rw_t4t_sm_read_ndef (BT_HDR *p_r_apdu)
 
     if (status_words != T4T_RSP_CMD_CMPLTED)
     {
-        rw_t4t_handle_error (NFC_STATUS_CMD_NOT_CMPLTD, *(p-2), *(p-1));
+        if (  (p_t4t->ext_apdu_len)
+            &&(p_t4t->sub_state == RW_T4T_SUBSTATE_WAIT_READ_RESP)  )
+        {
+            /* tag rejected extended Le in spite of MLe, read again with short Le */
+            RW_TRACE_DEBUG2 ("rw_t4t_sm_read_ndef (): extended Le rejected (0x%02X%02X)", *(p-2), *(p-1));
+
+            p_t4t->max_read_size = T4T_MAX_LENGTH_LE;
+
+            if (!rw_t4t_read_file (p_t4t->rw_offset, p_t4t->rw_length, TRUE))
+            {
+                rw_t4t_handle_error (NFC_STATUS_FAILED, 0, 0);
+            }
+        }
+        else
+        {
+            rw_t4t_handle_error (NFC_STATUS_CMD_NOT_CMPLTD, *(p-2), *(p-1));
+        }
         GKI_freebuf (p_r_apdu);
         return;
     }
@@ -1734,7 +1794,27 @@ static void rw_t4t_sm_update_ndef (BT_HDR  *p_r_apdu)
 
     if (status_words != T4T_RSP_CMD_CMPLTED)
     {
-        rw_t4t_handle_error (NFC_STATUS_CMD_NOT_CMPLTD, *(p-2), *(p-1));
+        if (  (p_t4t->ext_apdu_len)
+            &&(p_t4t->sub_state == RW_T4T_SUBSTATE_WAIT_UPDATE_RESP)  )
+        {
+            /* tag rejected extended Lc in spite of MLc, write the same data again with short Lc */
+            RW_TRACE_DEBUG2 ("rw_t4t_sm_update_ndef (): extended Lc rejected (0x%02X%02X)", *(p-2), *(p-1));
+
+            p_t4t->rw_offset       -= p_t4t->ext_apdu_len;
+            p_t4t->rw_length       += p_t4t->ext_apdu_len;
+            p_t4t->p_update_data   -= p_t4t->ext_apdu_len;
+            p_t4t->max_update_size  = T4T_MAX_LENGTH_LC;
+
+            if (!rw_t4t_update_file ())
+            {
+                rw_t4t_handle_error (NFC_STATUS_FAILED, 0, 0);
+                p_t4t->p_update_data = NULL;
+            }
+        }
+        else
+        {
+            rw_t4t_handle_error (NFC_STATUS_CMD_NOT_CMPLTD, *(p-2), *(p-1));
+        }
         return;
     }
 
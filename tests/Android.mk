@@ -0,0 +1,6 @@
+# Host-side tests for the stack and the PN547 HAL.
+# Build with "mmm <path>/tests" and run the binaries from out/host/<os>/bin.
+
+LOCAL_PATH:= $(call my-dir)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
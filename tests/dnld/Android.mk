@@ -0,0 +1,49 @@
+LOCAL_PATH:= $(call my-dir)
+HAL_DIR := ../../halimpl/pn547
+
+######################################
+# Pipelined firmware write against a simulated TML and PN547.
+# Runs the clean, lost response, stalled write and MEM_BSY scenarios and
+# reports the virtual transfer time; exits non-zero on failure.
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := nfc_dnld_sim_test
+LOCAL_MODULE_TAGS := tests
+LOCAL_CFLAGS := -DANDROID
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/$(HAL_DIR)/utils \
+    $(LOCAL_PATH)/$(HAL_DIR)/inc \
+    $(LOCAL_PATH)/$(HAL_DIR)/common \
+    $(LOCAL_PATH)/$(HAL_DIR)/dnld \
+    $(LOCAL_PATH)/$(HAL_DIR)/log \
+    $(LOCAL_PATH)/$(HAL_DIR)/tml
+LOCAL_SRC_FILES := \
+    phDnldNfc_SimTml.c \
+    $(HAL_DIR)/dnld/phDnldNfc.c \
+    $(HAL_DIR)/dnld/phDnldNfc_Internal.c \
+    $(HAL_DIR)/dnld/phDnldNfc_Utils.c
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -ldl -lpthread -lrt
+include $(BUILD_HOST_EXECUTABLE)
+
+######################################
+# Offline frame CRC index of a firmware image, installed next to the image
+# as FW_CRC_PATH.
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := nfc_dnld_crc_tool
+LOCAL_MODULE_TAGS := tests
+LOCAL_CFLAGS := -DANDROID
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/$(HAL_DIR)/utils \
+    $(LOCAL_PATH)/$(HAL_DIR)/inc \
+    $(LOCAL_PATH)/$(HAL_DIR)/common \
+    $(LOCAL_PATH)/$(HAL_DIR)/dnld \
+    $(LOCAL_PATH)/$(HAL_DIR)/log \
+    $(LOCAL_PATH)/$(HAL_DIR)/tml
+LOCAL_SRC_FILES := \
+    phDnldNfc_CrcTool.c \
+    $(HAL_DIR)/dnld/phDnldNfc_Utils.c
+LOCAL_STATIC_LIBRARIES := liblog
+LOCAL_LDLIBS := -ldl -lpthread
+include $(BUILD_HOST_EXECUTABLE)
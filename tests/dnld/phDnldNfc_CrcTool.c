@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Download Component
+ * Offline precompute of the frame CRC index of a firmware image.
+ *
+ * usage: nfc_dnld_crc_tool [-o <index>] <image>
+ *
+ * <image> is a firmware library exporting gphDnldNfc_DlSeq/gphDnldNfc_DlSeqSz
+ * built for the host, or the raw download sequence. The CRC16 of every frame
+ * is listed and, with -o, written in the format the HAL reads from
+ * FW_CRC_PATH, so the index does not have to be built on the target when the
+ * image is loaded.
+ *
+ * Exit status is 0 on success.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dlfcn.h>
+#include <phDnldNfc.h>
+#include <phDnldNfc_Internal.h>
+#include <phDnldNfc_Utils.h>
+#include <phNxpLog.h>
+
+nci_log_level_t gLog_level;
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_CrcToolReadImg
+**
+** Description      Reads the download sequence from a host firmware library,
+**                  or the file itself if it is not one
+**
+** Returns          Image buffer to be freed, NULL on failure
+**
+*******************************************************************************/
+static uint8_t *phDnldNfc_CrcToolReadImg(const char *pPath, uint16_t *pLen)
+{
+    void *pLib;
+    uint8_t **ppSeq;
+    uint16_t *pSeqSz;
+    uint8_t *pImg = NULL;
+    FILE *pFile;
+    long lLen;
+
+    pLib = dlopen(pPath, RTLD_LAZY);
+    if(NULL != pLib)
+    {
+        ppSeq = (uint8_t **)dlsym(pLib, "gphDnldNfc_DlSeq");
+        pSeqSz = (uint16_t *)dlsym(pLib, "gphDnldNfc_DlSeqSz");
+        if((NULL != ppSeq) && (NULL != pSeqSz) && (0 != *pSeqSz) &&
+           (NULL != (pImg = (uint8_t *)malloc(*pSeqSz))))
+        {
+            memcpy(pImg, *ppSeq, *pSeqSz);
+            *pLen = *pSeqSz;
+        }
+        dlclose(pLib);
+        return pImg;
+    }
+
+    pFile = fopen(pPath, "rb");
+    if(NULL == pFile)
+    {
+        return NULL;
+    }
+    if((0 == fseek(pFile, 0, SEEK_END)) && ((lLen = ftell(pFile)) > 0) && (lLen <= 0xFFFF) &&
+       (0 == fseek(pFile, 0, SEEK_SET)) && (NULL != (pImg = (uint8_t *)malloc(lLen))))
+    {
+        if(1 == fread(pImg, lLen, 1, pFile))
+        {
+            *pLen = (uint16_t)lLen;
+        }
+        else
+        {
+            free(pImg);
+            pImg = NULL;
+        }
+    }
+    fclose(pFile);
+
+    return pImg;
+}
+
+int main(int argc, char **argv)
+{
+    phDnldNfc_CrcIndex_t tIdx;
+    const char *pOut = NULL;
+    const char *pImgPath = NULL;
+    uint8_t *pImg;
+    uint16_t wLen = 0;
+    uint16_t wFwVer;
+    uint16_t wPos;
+    uint16_t wFrameLen;
+    int iArg;
+    int iRet = 0;
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        if((0 == strcmp(argv[iArg], "-o")) && ((iArg + 1) < argc))
+        {
+            pOut = argv[++iArg];
+        }
+        else if((NULL == pImgPath) && ('-' != argv[iArg][0]))
+        {
+            pImgPath = argv[iArg];
+        }
+        else
+        {
+            pImgPath = NULL;
+            break;
+        }
+    }
+    if(NULL == pImgPath)
+    {
+        fprintf(stderr, "usage: %s [-o <index>] <image>\n", argv[0]);
+        return 2;
+    }
+
+    pImg = phDnldNfc_CrcToolReadImg(pImgPath, &wLen);
+    if((NULL == pImg) || (wLen < 6))
+    {
+        fprintf(stderr, "%s: cannot read the image\n", pImgPath);
+        free(pImg);
+        return 1;
+    }
+
+    memset(&tIdx, 0, sizeof(tIdx));
+    if(NFCSTATUS_SUCCESS != phDnldNfc_BuildCrcIndex(&tIdx, pImg, wLen))
+    {
+        fprintf(stderr, "%s: no download frames\n", pImgPath);
+        free(pImg);
+        return 1;
+    }
+
+    /* same version bytes as phDnldNfc_InitImgInfo */
+    wFwVer = (((uint16_t)pImg[5] << 8U) | pImg[4]);
+
+    printf("FW version %04x, %u bytes, %u frames\n", wFwVer, wLen, tIdx.wNumFrames);
+    printf("FRAME  OFFSET   LEN  CRC16\n");
+    for(wPos = 0; wPos < tIdx.wNumFrames; wPos++)
+    {
+        wFrameLen = (((uint16_t)pImg[tIdx.pOffset[wPos]] << 8U) | pImg[tIdx.pOffset[wPos] + 1]);
+        printf("%5u  %6u  %4u   %04x\n", wPos, tIdx.pOffset[wPos], wFrameLen, tIdx.pCrc[wPos]);
+    }
+
+    if((NULL != pOut) && (NFCSTATUS_SUCCESS != phDnldNfc_SaveCrcIndex(&tIdx, wFwVer, pOut)))
+    {
+        fprintf(stderr, "%s: cannot write the index\n", pOut);
+        iRet = 1;
+    }
+
+    phDnldNfc_FreeCrcIndex(&tIdx);
+    free(pImg);
+
+    return iRet;
+}
@@ -0,0 +1,617 @@
+/*
+ * Copyright (C) 2026 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Download Component
+ * Host test of the pipelined write sequence against a simulated TML and PN547.
+ *
+ * The download engine (phDnldNfc*.c) is linked unchanged. TML, OSAL timers
+ * and the chip are replaced by a single threaded event loop on a virtual
+ * clock, so the timeout paths run in milliseconds of real time and every
+ * run is reproducible. Like the real TML, only one write is outstanding at
+ * a time, the single read is kept posted by the caller, and completions are
+ * delivered one by one on the client thread.
+ *
+ * Scenarios (all run by default, or one with -s <name>):
+ *   clean - every frame acknowledged
+ *   drop  - response of one frame lost; resend from the checkpoint
+ *   stall - write of one frame completes only after the response timeout
+ *           and its response is lost; the late completion of the abandoned
+ *           attempt has to be ignored and the resend deferred behind it
+ *   busy  - PN547 answers MEM_BSY once; frame resent after the retry delay
+ *
+ * A scenario passes when PN547 ends up with every frame in order, the write
+ * request completes with success, no write is issued while one is still
+ * queued in TML and nothing is sent after completion.
+ * Exit status is 0 when all selected scenarios pass.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <phDnldNfc.h>
+#include <phDnldNfc_Internal.h>
+#include <phDnldNfc_Cmd.h>
+#include <phOsalNfc_Timer.h>
+#include <phNxpLog.h>
+
+nci_log_level_t gLog_level;
+
+#define SIM_IMG_FRAMES          (96U)       /* Write frames in the test image */
+#define SIM_FAULT_FRAME         (40U)       /* Frame the fault is injected on */
+#define SIM_I2C_BYTE_US         (25U)       /* 400 kHz I2C incl. ACK, per byte */
+#define SIM_FLASH_US            (1800U)     /* PN547 frame program time */
+#define SIM_STALL_US            (3000000U)  /* Stalled write, beyond PHDNLDNFC_RSP_TIMEOUT */
+#define SIM_MAX_EVENTS          (32U)
+#define SIM_MAX_TIMERS          (4U)
+
+typedef enum
+{
+    SIM_FAULT_NONE = 0,
+    SIM_FAULT_DROP,
+    SIM_FAULT_STALL,
+    SIM_FAULT_BUSY
+} phDnldNfc_SimFault_t;
+
+typedef enum
+{
+    SIM_EV_WRITE_CMPL = 0,
+    SIM_EV_RSP,
+    SIM_EV_TIMER
+} phDnldNfc_SimEvType_t;
+
+typedef struct
+{
+    uint64_t qwTime;
+    uint32_t dwSeq;
+    phDnldNfc_SimEvType_t eType;
+    uint32_t dwArg;
+} phDnldNfc_SimEvent_t;
+
+typedef struct
+{
+    bool_t bUsed;
+    bool_t bArmed;
+    uint32_t dwGen;
+    pphOsalNfc_TimerCallbck_t pCb;
+    void *pCtxt;
+} phDnldNfc_SimTimer_t;
+
+typedef struct
+{
+    /* virtual clock and event queue */
+    uint64_t qwNow;
+    uint32_t dwSeq;
+    phDnldNfc_SimEvent_t aEvents[SIM_MAX_EVENTS];
+    uint32_t dwEvents;
+
+    /* TML */
+    bool_t bWrBusy;
+    uint32_t dwWrRejects;
+    uint8_t *pWrBuff;
+    uint16_t wWrLen;
+    pphTmlNfc_TransactCompletionCb_t pWrCb;
+    void *pWrCtxt;
+    bool_t bRdPosted;
+    uint8_t *pRdBuff;
+    uint16_t wRdLen;
+    pphTmlNfc_TransactCompletionCb_t pRdCb;
+    void *pRdCtxt;
+    phDnldNfc_SimTimer_t aTimers[SIM_MAX_TIMERS];
+
+    /* PN547 */
+    phDnldNfc_SimFault_t eFault;
+    uint32_t dwFramesRecvd;
+    uint32_t dwNextFrame;
+    uint32_t dwDupFrames;
+    uint32_t dwBadFrames;
+    bool_t bRspReady;
+    uint8_t aRsp[8];
+    uint16_t wRspLen;
+
+    /* host */
+    bool_t bDone;
+    NFCSTATUS wDoneStatus;
+    uint32_t dwWritesAfterDone;
+} phDnldNfc_SimCtxt_t;
+
+static phDnldNfc_SimCtxt_t gSim;
+static uint8_t *gpSimImg;
+static uint16_t gwSimImgLen;
+static uint16_t gaSimFrameOff[SIM_IMG_FRAMES];
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_SimPost
+**
+** Description      Queues an event dwDelayUs after the current virtual time.
+**                  Events due at the same time are delivered in post order.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phDnldNfc_SimPost(uint64_t qwDelayUs, phDnldNfc_SimEvType_t eType, uint32_t dwArg)
+{
+    phDnldNfc_SimEvent_t *pEv;
+
+    if(SIM_MAX_EVENTS == gSim.dwEvents)
+    {
+        fprintf(stderr, "event queue overflow\n");
+        abort();
+    }
+    pEv = &gSim.aEvents[gSim.dwEvents++];
+    pEv->qwTime = gSim.qwNow + qwDelayUs;
+    pEv->dwSeq = gSim.dwSeq++;
+    pEv->eType = eType;
+    pEv->dwArg = dwArg;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_SimCancelTimer
+**
+** Description      Drops the queued expiry of a stopped or restarted timer
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phDnldNfc_SimCancelTimer(uint32_t dwTimerIdx)
+{
+    uint32_t dwIdx = 0;
+
+    while(dwIdx < gSim.dwEvents)
+    {
+        if((SIM_EV_TIMER == gSim.aEvents[dwIdx].eType) &&
+           (dwTimerIdx == (gSim.aEvents[dwIdx].dwArg >> 16)))
+        {
+            gSim.aEvents[dwIdx] = gSim.aEvents[--gSim.dwEvents];
+        }
+        else
+        {
+            dwIdx++;
+        }
+    }
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_SimDevRecv
+**
+** Description      PN547 side: checks a received write frame against the image
+**                  and prepares the status response. A frame equal to the last
+**                  one programmed is a resend after a lost response and is
+**                  acknowledged again.
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phDnldNfc_SimDevRecv(const uint8_t *pFrame, uint16_t wLen, bool_t *pbDrop)
+{
+    uint16_t wCrc;
+    uint16_t wFrameLen;
+    uint8_t bStatus = PH_DL_STATUS_OK;
+    uint32_t dwIdx;
+
+    (gSim.dwFramesRecvd)++;
+    *pbDrop = FALSE;
+
+    wCrc = phDnldNfc_CalcCrc16((uint8_t *)pFrame, (uint16_t)(wLen - PHDNLDNFC_FRAME_CRC_LEN));
+    wFrameLen = (uint16_t)(wLen - PHDNLDNFC_FRAME_CRC_LEN);
+
+    if((pFrame[wLen - 2] != (uint8_t)(wCrc >> 8)) || (pFrame[wLen - 1] != (uint8_t)wCrc))
+    {
+        (gSim.dwBadFrames)++;
+        bStatus = PH_DL_STATUS_PROTOCOL_ERROR;
+    }
+    else if((gSim.dwNextFrame < SIM_IMG_FRAMES) &&
+            (0 == memcmp(pFrame, &gpSimImg[gaSimFrameOff[gSim.dwNextFrame]], wFrameLen)))
+    {
+        dwIdx = gSim.dwNextFrame;
+        if((SIM_FAULT_BUSY == gSim.eFault) && (SIM_FAULT_FRAME == dwIdx))
+        {
+            gSim.eFault = SIM_FAULT_NONE;
+            bStatus = PH_DL_STATUS_MEM_BSY;
+        }
+        else
+        {
+            (gSim.dwNextFrame)++;
+        }
+        if(((SIM_FAULT_DROP == gSim.eFault) || (SIM_FAULT_STALL == gSim.eFault)) &&
+           (SIM_FAULT_FRAME == dwIdx))
+        {
+            gSim.eFault = SIM_FAULT_NONE;
+            *pbDrop = TRUE;
+        }
+    }
+    else if((0 != gSim.dwNextFrame) &&
+            (0 == memcmp(pFrame, &gpSimImg[gaSimFrameOff[gSim.dwNextFrame - 1]], wFrameLen)))
+    {
+        (gSim.dwDupFrames)++;
+    }
+    else
+    {
+        (gSim.dwBadFrames)++;
+        bStatus = PH_DL_STATUS_PROTOCOL_ERROR;
+    }
+
+    gSim.aRsp[0] = 0x00;
+    gSim.aRsp[1] = 0x01;
+    gSim.aRsp[2] = bStatus;
+    wCrc = phDnldNfc_CalcCrc16(gSim.aRsp, 3);
+    gSim.aRsp[3] = (uint8_t)(wCrc >> 8);
+    gSim.aRsp[4] = (uint8_t)wCrc;
+    gSim.wRspLen = 5;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_Write
+**
+** Description      Simulated TML write; one write outstanding at a time
+**
+** Returns          NFCSTATUS_PENDING, or NFCSTATUS_BUSY while a write is queued
+**
+*******************************************************************************/
+NFCSTATUS phTmlNfc_Write(uint8_t *pBuffer, uint16_t wLength, pphTmlNfc_TransactCompletionCb_t pTmlWriteComplete, void *pContext)
+{
+    uint64_t qwDur = (uint64_t)wLength * SIM_I2C_BYTE_US;
+
+    if(TRUE == gSim.bWrBusy)
+    {
+        (gSim.dwWrRejects)++;
+        return NFCSTATUS_BUSY;
+    }
+    if(TRUE == gSim.bDone)
+    {
+        (gSim.dwWritesAfterDone)++;
+    }
+
+    gSim.bWrBusy = TRUE;
+    gSim.pWrBuff = pBuffer;
+    gSim.wWrLen = wLength;
+    gSim.pWrCb = pTmlWriteComplete;
+    gSim.pWrCtxt = pContext;
+
+    if((SIM_FAULT_STALL == gSim.eFault) && (SIM_FAULT_FRAME == gSim.dwNextFrame))
+    {
+        qwDur = SIM_STALL_US;
+    }
+    phDnldNfc_SimPost(qwDur, SIM_EV_WRITE_CMPL, 0);
+
+    return NFCSTATUS_PENDING;
+}
+
+/*******************************************************************************
+**
+** Function         phTmlNfc_Read
+**
+** Description      Simulated TML read; delivers a response already sent by
+**                  PN547 right away
+**
+** Returns          NFCSTATUS_PENDING
+**
+*******************************************************************************/
+NFCSTATUS phTmlNfc_Read(uint8_t *pBuffer, uint16_t wLength, pphTmlNfc_TransactCompletionCb_t pTmlReadComplete, void *pContext)
+{
+    gSim.bRdPosted = TRUE;
+    gSim.pRdBuff = pBuffer;
+    gSim.wRdLen = wLength;
+    gSim.pRdCb = pTmlReadComplete;
+    gSim.pRdCtxt = pContext;
+
+    if(TRUE == gSim.bRspReady)
+    {
+        phDnldNfc_SimPost(0, SIM_EV_RSP, 0);
+    }
+
+    return NFCSTATUS_PENDING;
+}
+
+NFCSTATUS phTmlNfc_ReadAbort(void)
+{
+    gSim.bRdPosted = FALSE;
+    return NFCSTATUS_SUCCESS;
+}
+
+NFCSTATUS phTmlNfc_IoCtl(phTmlNfc_ControlCode_t eControlCode)
+{
+    UNUSED(eControlCode);
+    return NFCSTATUS_SUCCESS;
+}
+
+uint32_t phOsalNfc_Timer_Create(void)
+{
+    uint32_t dwIdx;
+
+    for(dwIdx = 0; dwIdx < SIM_MAX_TIMERS; dwIdx++)
+    {
+        if(FALSE == gSim.aTimers[dwIdx].bUsed)
+        {
+            memset(&gSim.aTimers[dwIdx], 0, sizeof(gSim.aTimers[dwIdx]));
+            gSim.aTimers[dwIdx].bUsed = TRUE;
+            return (dwIdx + 1);
+        }
+    }
+    return 0;
+}
+
+NFCSTATUS phOsalNfc_Timer_Start(uint32_t dwTimerId, uint32_t dwRegTimeCnt, pphOsalNfc_TimerCallbck_t pApplication_callback, void *pContext)
+{
+    phDnldNfc_SimTimer_t *pTimer;
+
+    if((0 == dwTimerId) || (SIM_MAX_TIMERS < dwTimerId) || (FALSE == gSim.aTimers[dwTimerId - 1].bUsed))
+    {
+        return NFCSTATUS_INVALID_PARAMETER;
+    }
+    pTimer = &gSim.aTimers[dwTimerId - 1];
+    phDnldNfc_SimCancelTimer(dwTimerId - 1);
+    (pTimer->dwGen)++;
+    pTimer->bArmed = TRUE;
+    pTimer->pCb = pApplication_callback;
+    pTimer->pCtxt = pContext;
+    phDnldNfc_SimPost((uint64_t)dwRegTimeCnt * 1000U, SIM_EV_TIMER,
+            ((dwTimerId - 1) << 16) | (pTimer->dwGen & 0xFFFFU));
+
+    return NFCSTATUS_SUCCESS;
+}
+
+NFCSTATUS phOsalNfc_Timer_Stop(uint32_t dwTimerId)
+{
+    if((0 == dwTimerId) || (SIM_MAX_TIMERS < dwTimerId))
+    {
+        return NFCSTATUS_INVALID_PARAMETER;
+    }
+    gSim.aTimers[dwTimerId - 1].bArmed = FALSE;
+    phDnldNfc_SimCancelTimer(dwTimerId - 1);
+    return NFCSTATUS_SUCCESS;
+}
+
+NFCSTATUS phOsalNfc_Timer_Delete(uint32_t dwTimerId)
+{
+    if((0 == dwTimerId) || (SIM_MAX_TIMERS < dwTimerId))
+    {
+        return NFCSTATUS_INVALID_PARAMETER;
+    }
+    gSim.aTimers[dwTimerId - 1].bArmed = FALSE;
+    gSim.aTimers[dwTimerId - 1].bUsed = FALSE;
+    phDnldNfc_SimCancelTimer(dwTimerId - 1);
+    return NFCSTATUS_SUCCESS;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_SimDispatch
+**
+** Description      Delivers the earliest queued event
+**
+** Returns          FALSE once the queue is empty
+**
+*******************************************************************************/
+static bool_t phDnldNfc_SimDispatch(void)
+{
+    phDnldNfc_SimEvent_t tEv;
+    phTmlNfc_TransactInfo_t tInfo;
+    phDnldNfc_SimTimer_t *pTimer;
+    pphTmlNfc_TransactCompletionCb_t pCb;
+    uint32_t dwIdx, dwMin = 0;
+    bool_t bDrop;
+
+    if(0 == gSim.dwEvents)
+    {
+        return FALSE;
+    }
+    for(dwIdx = 1; dwIdx < gSim.dwEvents; dwIdx++)
+    {
+        if((gSim.aEvents[dwIdx].qwTime < gSim.aEvents[dwMin].qwTime) ||
+           ((gSim.aEvents[dwIdx].qwTime == gSim.aEvents[dwMin].qwTime) &&
+            (gSim.aEvents[dwIdx].dwSeq < gSim.aEvents[dwMin].dwSeq)))
+        {
+            dwMin = dwIdx;
+        }
+    }
+    tEv = gSim.aEvents[dwMin];
+    gSim.aEvents[dwMin] = gSim.aEvents[--gSim.dwEvents];
+    gSim.qwNow = tEv.qwTime;
+
+    switch(tEv.eType)
+    {
+        case SIM_EV_WRITE_CMPL:
+        {
+            phDnldNfc_SimDevRecv(gSim.pWrBuff, gSim.wWrLen, &bDrop);
+            if(FALSE == bDrop)
+            {
+                phDnldNfc_SimPost(SIM_FLASH_US + (gSim.wRspLen * SIM_I2C_BYTE_US), SIM_EV_RSP, 1);
+            }
+            tInfo.wStatus = NFCSTATUS_SUCCESS;
+            tInfo.pBuff = gSim.pWrBuff;
+            tInfo.wLength = gSim.wWrLen;
+            gSim.bWrBusy = FALSE;
+            gSim.pWrCb(gSim.pWrCtxt, &tInfo);
+            break;
+        }
+        case SIM_EV_RSP:
+        {
+            if(1 == tEv.dwArg)
+            {
+                gSim.bRspReady = TRUE;
+            }
+            if((TRUE == gSim.bRspReady) && (TRUE == gSim.bRdPosted))
+            {
+                gSim.bRspReady = FALSE;
+                gSim.bRdPosted = FALSE;
+                memcpy(gSim.pRdBuff, gSim.aRsp, gSim.wRspLen);
+                tInfo.wStatus = NFCSTATUS_SUCCESS;
+                tInfo.pBuff = gSim.pRdBuff;
+                tInfo.wLength = gSim.wRspLen;
+                pCb = gSim.pRdCb;
+                pCb(gSim.pRdCtxt, &tInfo);
+            }
+            break;
+        }
+        case SIM_EV_TIMER:
+        {
+            pTimer = &gSim.aTimers[tEv.dwArg >> 16];
+            if((TRUE == pTimer->bArmed) && ((pTimer->dwGen & 0xFFFFU) == (tEv.dwArg & 0xFFFFU)))
+            {
+                pTimer->bArmed = FALSE;
+                pTimer->pCb((tEv.dwArg >> 16) + 1, pTimer->pCtxt);
+            }
+            break;
+        }
+    }
+
+    return TRUE;
+}
+
+static void phDnldNfc_SimWriteCb(void *pContext, NFCSTATUS wStatus, void *pInfo)
+{
+    UNUSED(pContext);
+    UNUSED(pInfo);
+    gSim.bDone = TRUE;
+    gSim.wDoneStatus = wStatus;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_SimBuildImg
+**
+** Description      Builds a firmware image of SIM_IMG_FRAMES unchunked write
+**                  frames ([len][PH_DL_CMD_WRITE][payload], no CRC) with
+**                  varying lengths
+**
+** Returns          None
+**
+*******************************************************************************/
+static void phDnldNfc_SimBuildImg(void)
+{
+    uint32_t dwFrame, dwIdx;
+    uint16_t wPld, wOff = 0;
+
+    gpSimImg = (uint8_t *)malloc(SIM_IMG_FRAMES * PHDNLDNFC_CMDRESP_MAX_BUFF_SIZE);
+    srand(547);
+    for(dwFrame = 0; dwFrame < SIM_IMG_FRAMES; dwFrame++)
+    {
+        wPld = (uint16_t)(PHDNLDNFC_CMDRESP_MAX_PLD_SIZE - (rand() % 64));
+        gaSimFrameOff[dwFrame] = wOff;
+        gpSimImg[wOff++] = (uint8_t)(wPld >> 8);
+        gpSimImg[wOff++] = (uint8_t)wPld;
+        gpSimImg[wOff] = PH_DL_CMD_WRITE;
+        for(dwIdx = 1; dwIdx < wPld; dwIdx++)
+        {
+            gpSimImg[wOff + dwIdx] = (uint8_t)rand();
+        }
+        wOff += wPld;
+    }
+    gwSimImgLen = wOff;
+}
+
+/*******************************************************************************
+**
+** Function         phDnldNfc_SimRun
+**
+** Description      Runs one full image write with the given fault injected and
+**                  checks that PN547 ended up with every frame exactly in order
+**
+** Returns          0 on success, 1 on failure
+**
+*******************************************************************************/
+static int phDnldNfc_SimRun(const char *pName, phDnldNfc_SimFault_t eFault)
+{
+    phDnldNfc_Buff_t tImg;
+    NFCSTATUS wStatus;
+    uint32_t dwMs;
+    bool_t bPass;
+
+    memset(&gSim, 0, sizeof(gSim));
+    gSim.eFault = eFault;
+
+    phDnldNfc_SetHwDevHandle();
+    tImg.pBuff = gpSimImg;
+    tImg.wLen = gwSimImgLen;
+    wStatus = phDnldNfc_Write(FALSE, &tImg, &phDnldNfc_SimWriteCb, &gSim);
+    if(NFCSTATUS_PENDING != wStatus)
+    {
+        printf("%-6s FAIL: write request not accepted (0x%x)\n", pName, wStatus);
+        return 1;
+    }
+
+    /* run past completion so late completions get delivered as well */
+    while(TRUE == phDnldNfc_SimDispatch())
+    {
+    }
+
+    dwMs = (uint32_t)(gSim.qwNow / 1000U);
+    bPass = (TRUE == gSim.bDone) && (NFCSTATUS_SUCCESS == gSim.wDoneStatus) &&
+            (SIM_IMG_FRAMES == gSim.dwNextFrame) && (0 == gSim.dwBadFrames) &&
+            (0 == gSim.dwWritesAfterDone) && (0 == gSim.dwWrRejects) &&
+            (FALSE == gSim.bWrBusy);
+
+    printf("%-6s %s: %u bytes in %u ms (%u KB/s), %u frames sent, %u resent, "
+            "%u writes rejected busy, status 0x%x\n",
+            pName, (TRUE == bPass) ? "PASS" : "FAIL", gwSimImgLen, dwMs,
+            (0 == dwMs) ? 0 : (uint32_t)((gwSimImgLen * 1000U / 1024U) / dwMs),
+            gSim.dwFramesRecvd, gSim.dwDupFrames, gSim.dwWrRejects, gSim.wDoneStatus);
+
+    return (TRUE == bPass) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct
+    {
+        const char *pName;
+        phDnldNfc_SimFault_t eFault;
+    } aScenarios[] = {
+        { "clean", SIM_FAULT_NONE },
+        { "drop",  SIM_FAULT_DROP },
+        { "stall", SIM_FAULT_STALL },
+        { "busy",  SIM_FAULT_BUSY },
+    };
+    const char *pOnly = NULL;
+    uint32_t dwIdx;
+    int iFailed = 0;
+    int iArg;
+
+    for(iArg = 1; iArg < argc; iArg++)
+    {
+        if((0 == strcmp(argv[iArg], "-s")) && ((iArg + 1) < argc))
+        {
+            pOnly = argv[++iArg];
+        }
+        else if(0 == strcmp(argv[iArg], "-v"))
+        {
+            gLog_level.dnld_log_level = NXPLOG_LOG_DEBUG_LOGLEVEL;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [-v] [-s clean|drop|stall|busy]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    phDnldNfc_SimBuildImg();
+    for(dwIdx = 0; dwIdx < (sizeof(aScenarios) / sizeof(aScenarios[0])); dwIdx++)
+    {
+        if((NULL == pOnly) || (0 == strcmp(pOnly, aScenarios[dwIdx].pName)))
+        {
+            iFailed += phDnldNfc_SimRun(aScenarios[dwIdx].pName, aScenarios[dwIdx].eFault);
+        }
+    }
+    phDnldNfc_ReSetHwDevHandle();
+    free(gpSimImg);
+
+    return (0 == iFailed) ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+LOCAL_PATH:= $(call my-dir)
+NFC_DIR := ../../src
+
+######################################
+# Replays a buffer workload against the GKI buffer pools and prints the
+# pool statistics next to the configured pool sizes; exits non-zero if
+# the statistics do not match the replayed operations.
+
+include $(CLEAR_VARS)
+LOCAL_MODULE := nfc_gki_pool_stats_test
+LOCAL_MODULE_TAGS := tests
+LOCAL_CFLAGS := -DANDROID -DBUILDCFG=1 -DNFCC_PN547
+LOCAL_C_INCLUDES := \
+    $(LOCAL_PATH)/$(NFC_DIR)/include \
+    $(LOCAL_PATH)/$(NFC_DIR)/gki/ulinux \
+    $(LOCAL_PATH)/$(NFC_DIR)/gki/common \
+    $(LOCAL_PATH)/$(NFC_DIR)/nfc/include \
+    $(LOCAL_PATH)/$(NFC_DIR)/hal/include \
+    $(LOCAL_PATH)/$(NFC_DIR)/nfa/include
+LOCAL_SRC_FILES := \
+    gki_pool_stats_test.c \
+    $(NFC_DIR)/gki/common/gki_buffer.c
+include $(BUILD_HOST_EXECUTABLE)
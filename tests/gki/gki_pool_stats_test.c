@@ -0,0 +1,372 @@
+/******************************************************************************
+ *
+ *  Copyright (C) 2026 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/******************************************************************************
+ *
+ *  Host tool that replays a buffer workload against the GKI buffer pools
+ *  (gki_buffer.c, linked unchanged) and prints the pool statistics, to
+ *  right-size GKI_BUFn_MAX in gki_target.h.
+ *
+ *  usage: gki_pool_stats_test [workload_file]
+ *
+ *  Without a file a built-in NFC workload is replayed: NCI packets from
+ *  NFC_NCI_POOL_ID received in NCIT_TASK, NFA API messages from GKI_getbuf()
+ *  sent by application threads and LLCP PDUs from LLCP_POOL_ID in NFC_TASK,
+ *  followed by a burst that exhausts the NCI pool.
+ *
+ *  Workload file, one operation per line, '#' starts a comment:
+ *      <task> get <size> <tag>     GKI_getbuf(size) owned by GKI task <task>
+ *      <task> pool <pool> <tag>    GKI_getpoolbuf(pool)
+ *      free <tag>                  GKI_freebuf() of the buffer <tag>
+ *  <task> is a GKI task id, or x for a thread which is not a GKI task.
+ *  Tags are numbers below GKI_STATS_TEST_MAX_TAGS.
+ *
+ *  The statistics are cross-checked against the replayed operations;
+ *  the exit status is non-zero if they do not match.
+ *
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "gki_int.h"
+#include "nfc_target.h"
+
+#define GKI_STATS_TEST_MAX_TAGS     1024
+#define GKI_STATS_TEST_NON_GKI_TASK 0xFF
+
+/* GKI OS layer stand-in; the replay is single threaded */
+tGKI_CB gki_cb;
+static UINT8 gki_stats_test_task;
+static UINT32 gki_stats_test_exceptions;
+
+/* Replay state */
+static void  *gki_stats_test_bufs[GKI_STATS_TEST_MAX_TAGS];
+static UINT32 gki_stats_test_ok;
+static UINT32 gki_stats_test_failed;
+
+void GKI_disable (void)
+{
+}
+
+void GKI_enable (void)
+{
+}
+
+UINT8 GKI_get_taskid (void)
+{
+    return (gki_stats_test_task);
+}
+
+UINT8 GKI_send_event (UINT8 task_id, UINT16 event)
+{
+    return (GKI_SUCCESS);
+}
+
+void *GKI_os_malloc (UINT32 size)
+{
+    return (malloc(size));
+}
+
+void GKI_os_free (void *p_mem)
+{
+    free(p_mem);
+}
+
+void GKI_exception (UINT16 code, char *msg)
+{
+    gki_stats_test_exceptions++;
+    printf("GKI exception %u: %s\n", code, msg);
+}
+
+void LogMsg (UINT32 trace_set_mask, const char *fmt_str, ...)
+{
+    va_list ap;
+
+    va_start(ap, fmt_str);
+    vprintf(fmt_str, ap);
+    va_end(ap);
+    printf("\n");
+}
+
+/*******************************************************************************
+**
+** Function         gki_stats_test_get
+**
+** Description      Allocates buffer <tag> for <task>, from pool_id or, if
+**                  pool_id is GKI_NUM_TOTAL_BUF_POOLS, with GKI_getbuf(size)
+**
+** Returns          TRUE if the operation is valid
+**
+*******************************************************************************/
+static BOOLEAN gki_stats_test_get (UINT8 task, UINT8 pool_id, UINT16 size, UINT32 tag)
+{
+    if ((tag >= GKI_STATS_TEST_MAX_TAGS) || (gki_stats_test_bufs[tag] != NULL))
+        return (FALSE);
+
+    gki_stats_test_task = task;
+    if (pool_id < GKI_NUM_TOTAL_BUF_POOLS)
+        gki_stats_test_bufs[tag] = GKI_getpoolbuf(pool_id);
+    else
+        gki_stats_test_bufs[tag] = GKI_getbuf(size);
+
+    if (gki_stats_test_bufs[tag] != NULL)
+        gki_stats_test_ok++;
+    else
+        gki_stats_test_failed++;
+
+    return (TRUE);
+}
+
+/*******************************************************************************
+**
+** Function         gki_stats_test_free
+**
+** Description      Frees buffer <tag>; freeing a failed allocation is a no-op
+**
+** Returns          TRUE if the operation is valid
+**
+*******************************************************************************/
+static BOOLEAN gki_stats_test_free (UINT32 tag)
+{
+    if (tag >= GKI_STATS_TEST_MAX_TAGS)
+        return (FALSE);
+
+    if (gki_stats_test_bufs[tag] != NULL)
+    {
+        GKI_freebuf(gki_stats_test_bufs[tag]);
+        gki_stats_test_bufs[tag] = NULL;
+    }
+    return (TRUE);
+}
+
+/*******************************************************************************
+**
+** Function         gki_stats_test_replay_file
+**
+** Description      Replays a workload file
+**
+** Returns          TRUE if every line was valid
+**
+*******************************************************************************/
+static BOOLEAN gki_stats_test_replay_file (const char *p_path)
+{
+    FILE    *fd;
+    char    line[128];
+    char    task_str[8], op[8];
+    unsigned int arg, tag;
+    UINT8   task;
+    UINT32  line_no = 0;
+    BOOLEAN ok = TRUE;
+
+    if ((fd = fopen(p_path, "r")) == NULL)
+    {
+        printf("cannot open %s\n", p_path);
+        return (FALSE);
+    }
+
+    while (fgets(line, sizeof(line), fd) != NULL)
+    {
+        line_no++;
+        if (strchr(line, '#') != NULL)
+            *strchr(line, '#') = '\0';
+
+        if (sscanf(line, " free %u", &tag) == 1)
+        {
+            ok = gki_stats_test_free(tag);
+        }
+        else if (sscanf(line, " %7s %7s %u %u", task_str, op, &arg, &tag) == 4)
+        {
+            task = (strcmp(task_str, "x") == 0) ? GKI_STATS_TEST_NON_GKI_TASK : (UINT8)atoi(task_str);
+
+            if (strcmp(op, "get") == 0)
+                ok = gki_stats_test_get(task, GKI_NUM_TOTAL_BUF_POOLS, (UINT16)arg, tag);
+            else if ((strcmp(op, "pool") == 0) && (arg < GKI_NUM_TOTAL_BUF_POOLS))
+                ok = gki_stats_test_get(task, (UINT8)arg, 0, tag);
+            else
+                ok = FALSE;
+        }
+        else
+        {
+            ok = (strspn(line, " \t\r\n") == strlen(line));
+        }
+
+        if (!ok)
+        {
+            printf("%s:%lu: invalid operation\n", p_path, (unsigned long)line_no);
+            break;
+        }
+    }
+
+    fclose(fd);
+    return (ok);
+}
+
+/*******************************************************************************
+**
+** Function         gki_stats_test_replay_builtin
+**
+** Description      Replays the built-in NFC workload
+**
+** Returns          void
+**
+*******************************************************************************/
+static void gki_stats_test_replay_builtin (void)
+{
+    tGKI_POOL_STATS stats;
+    UINT32 xx, tag, burst;
+
+    srand(1);
+
+    /* steady state: a window of NCI, NFA and LLCP buffers in flight */
+    for (xx = 0; xx < 5000; xx++)
+    {
+        tag = xx % 32;
+        gki_stats_test_free(tag);
+
+        switch (rand() % 4)
+        {
+        case 0:
+        case 1:
+            gki_stats_test_get(NCIT_TASK, NFC_NCI_POOL_ID, 0, tag);
+            break;
+        case 2:
+            gki_stats_test_get(GKI_STATS_TEST_NON_GKI_TASK, GKI_NUM_TOTAL_BUF_POOLS,
+                               (UINT16)(16 + rand() % 240), tag);
+            break;
+        default:
+            gki_stats_test_get(NFC_TASK, LLCP_POOL_ID, 0, tag);
+            break;
+        }
+    }
+    for (tag = 0; tag < 32; tag++)
+        gki_stats_test_free(tag);
+
+    /* burst of NCI packets larger than the NCI pool */
+    GKI_get_pool_stats(NFC_NCI_POOL_ID, &stats);
+    burst = stats.total + 8;
+    for (tag = 0; tag < burst; tag++)
+        gki_stats_test_get(NCIT_TASK, NFC_NCI_POOL_ID, 0, tag);
+    for (tag = 0; tag < burst; tag++)
+        gki_stats_test_free(tag);
+}
+
+/*******************************************************************************
+**
+** Function         gki_stats_test_check
+**
+** Description      Cross-checks the statistics against the replayed
+**                  operations and prints the high-water marks next to the
+**                  configured pool sizes
+**
+** Returns          TRUE if consistent
+**
+*******************************************************************************/
+static BOOLEAN gki_stats_test_check (BOOLEAN all_freed)
+{
+    tGKI_POOL_STATS stats;
+    UINT32  alloc_sum = 0, task_sum;
+    UINT8   xx, task_id;
+    BOOLEAN ok = TRUE;
+
+    printf("\nPOOL  SIZE  TOTAL  MAX  HEADROOM\n");
+    for (xx = 0; xx < GKI_NUM_TOTAL_BUF_POOLS; xx++)
+    {
+        if ((!GKI_get_pool_stats(xx, &stats)) || (stats.total == 0))
+            continue;
+
+        task_sum = 0;
+        for (task_id = 0; task_id <= GKI_STATS_OTHER_TASK; task_id++)
+            task_sum += stats.task_alloc_cnt[task_id];
+
+        if ((task_sum != stats.alloc_cnt) || (stats.max_cnt > stats.total) ||
+            (all_freed && (stats.cur_cnt != 0)))
+        {
+            printf("pool %u: inconsistent statistics\n", xx);
+            ok = FALSE;
+        }
+        alloc_sum += stats.alloc_cnt;
+
+        printf("%4u %5u %6u %4u %9d%s\n", xx, stats.size, stats.total, stats.max_cnt,
+               (int)stats.total - (int)stats.max_cnt,
+               (stats.fail_cnt != 0) ? "  exhausted" : "");
+    }
+
+    if (alloc_sum != gki_stats_test_ok)
+    {
+        printf("%lu allocations counted, %lu replayed\n",
+               (unsigned long)alloc_sum, (unsigned long)gki_stats_test_ok);
+        ok = FALSE;
+    }
+    return (ok);
+}
+
+int main (int argc, char **argv)
+{
+    tGKI_POOL_STATS stats;
+    BOOLEAN ok;
+    UINT8   xx;
+
+    gki_buffer_init();
+
+    /* discard the allocations made at startup, as before a replay */
+    GKI_reset_pool_stats();
+
+    if (argc > 1)
+    {
+        ok = gki_stats_test_replay_file(argv[1]);
+    }
+    else
+    {
+        gki_stats_test_replay_builtin();
+        ok = TRUE;
+    }
+
+    printf("%lu allocations, %lu failed\n\n",
+           (unsigned long)gki_stats_test_ok, (unsigned long)gki_stats_test_failed);
+    GKI_dump_pool_stats();
+    ok = gki_stats_test_check(argc == 1) && ok;
+
+    if (argc == 1)
+    {
+        /* the burst must have exhausted the NCI pool and fallen back */
+        GKI_get_pool_stats(NFC_NCI_POOL_ID, &stats);
+        if ((stats.fail_cnt == 0) || (stats.fallback_cnt == 0) || (stats.max_cnt != stats.total))
+        {
+            printf("NCI pool exhaustion not accounted\n");
+            ok = FALSE;
+        }
+    }
+
+    GKI_reset_pool_stats();
+    for (xx = 0; xx < GKI_NUM_TOTAL_BUF_POOLS; xx++)
+    {
+        GKI_get_pool_stats(xx, &stats);
+        if ((stats.alloc_cnt != 0) || (stats.fail_cnt != 0) || (stats.max_cnt != stats.cur_cnt))
+        {
+            printf("pool %u: not cleared by GKI_reset_pool_stats\n", xx);
+            ok = FALSE;
+        }
+    }
+
+    if (gki_stats_test_exceptions != 0)
+        ok = FALSE;
+
+    printf("\n%s\n", ok ? "PASS" : "FAIL");
+    return (ok ? 0 : 1);
+}